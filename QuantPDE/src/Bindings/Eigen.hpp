@@ -43,8 +43,42 @@ typedef Eigen::SparseMatrix<Real>::InnerIterator MatrixInnerIterator;
 
 typedef Eigen::VectorXi IntegerVector;
 
+/**
+ * An incomplete LU preconditioner that can be told to keep its factors when
+ * it is next computed (e.g. because the matrix has barely changed).
+ */
+class ReusableIncompleteLUT : public Eigen::IncompleteLUT<Real> {
+
+	bool keep;
+
+public:
+
+	/**
+	 * Constructor.
+	 */
+	ReusableIncompleteLUT() noexcept : keep(false) {
+	}
+
+	template <typename M>
+	ReusableIncompleteLUT &compute(const M &A) {
+		if(!keep) {
+			Eigen::IncompleteLUT<Real>::compute(A);
+		}
+		return *this;
+	}
+
+	/**
+	 * @param keep If true, the next call to compute leaves the factors
+	 *             as they are.
+	 */
+	void keepFactors(bool keep) {
+		this->keep = keep;
+	}
+
+};
+
 // BiCGSTAB with IncompleteLUT preconditioner
-typedef Eigen::BiCGSTAB<Matrix, Eigen::IncompleteLUT<Real>> BiCGSTAB;
+typedef Eigen::BiCGSTAB<Matrix, ReusableIncompleteLUT> BiCGSTAB;
 
 typedef Eigen::SparseLU<Matrix, Eigen::NaturalOrdering<Index>> SparseLU;
 
@@ -65,6 +99,42 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Compares two (compressed) matrices.
+ * @return The number of rows at which the values differ, or -1 if the
+ *         sparsity patterns differ.
+ */
+inline Index changedRows(const Matrix &A, const Matrix &B) {
+	if(A.rows() != B.rows() || A.cols() != B.cols() || !A.isCompressed()
+			|| !B.isCompressed() || A.nonZeros() != B.nonZeros()) {
+		return -1;
+	}
+
+	const Index *outerA = A.outerIndexPtr(), *outerB = B.outerIndexPtr();
+	const Index *innerA = A.innerIndexPtr(), *innerB = B.innerIndexPtr();
+	const Real *valueA = A.valuePtr(), *valueB = B.valuePtr();
+
+	Index changed = 0;
+	for(Index i = 0; i < A.outerSize(); ++i) {
+		if(outerA[i + 1] != outerB[i + 1]) {
+			return -1;
+		}
+
+		bool same = true;
+		for(Index k = outerA[i]; k < outerA[i + 1]; ++k) {
+			if(innerA[k] != innerB[k]) {
+				return -1;
+			}
+			same = same && valueA[k] == valueB[k];
+		}
+		changed += !same;
+	}
+
+	return changed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 /**
  * A pure virtual class representing a solver for equations of type \f$Ax=b\f$.
  */
@@ -177,13 +247,31 @@ private:
 
 	BiCGSTAB solver;
 
+	// Largest fraction of rows that may change before the preconditioner
+	// is recomputed
+	Real reuse;
+
+	// The matrix the preconditioner was last computed from
+	Matrix factored;
+
 	virtual void initialize() {
 
 		#ifndef VIENNACL_WITH_EIGEN
 
+			bool keep = false;
+			if(reuse > 0.) {
+				const Index changed = changedRows(A, factored);
+				keep = changed >= 0 && changed <= reuse * A.rows();
+			}
+
+			solver.preconditioner().keepFactors(keep);
 			solver.compute(A);
 			assert( solver.info() == Eigen::Success );
 
+			if(reuse > 0. && !keep) {
+				factored = A;
+			}
+
 		#endif
 
 	}
@@ -193,7 +281,20 @@ public:
 	/**
 	 * Constructor.
 	 */
-	BiCGSTABSolver() noexcept : LinearSolver() {
+	BiCGSTABSolver() noexcept : LinearSolver(), reuse(0.) {
+	}
+
+	/**
+	 * Keeps the incomplete LU preconditioner of a previous matrix as long
+	 * as the new matrix has the same sparsity pattern and differs from it
+	 * in at most the given fraction of rows. This trades a few extra
+	 * iterations for fewer factorizations (e.g. in late policy
+	 * iterations, where only a few rows change control).
+	 * @param fraction The fraction of rows (0 to always recompute).
+	 */
+	void reusePreconditioner(Real fraction) {
+		reuse = fraction;
+		factored = Matrix();
 	}
 
 	virtual Vector solve(const Vector &b, const Vector &guess) {
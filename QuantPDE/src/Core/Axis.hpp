@@ -6,6 +6,8 @@
 #include <cstring>          // std::memcpy
 #include <initializer_list> // std::initializer_list
 #include <iostream>         // std::ostream
+#include <memory>           // std::default_delete, std::shared_ptr
+#include <utility>          // std::move
 
 namespace QuantPDE {
 
@@ -14,22 +16,49 @@ namespace QuantPDE {
  * interval (e.g. \f$\left\{x_i\right\}\f$, where
  * \f$a \equiv x_1 < \ldots < x_n \equiv b\f$; the \f$x_i\f$ are referred to
  * as ticks).
+ *
+ * The ticks are reference-counted and shared between copies, so that copying
+ * an axis (and hence a grid or an interpolant holding a grid) takes constant
+ * time. An axis that shares its ticks makes a private copy of them before they
+ * are modified.
  */
 class Axis final {
 
 	Index length;
+	std::shared_ptr<Real> storage;
 	Real *n;
+	bool uniformSpacing;
 
-	Axis() noexcept : length(0), n(nullptr) {
+	static std::shared_ptr<Real> allocate(Index length) {
+		return std::shared_ptr<Real>( new Real[length],
+				std::default_delete<Real[]>() );
 	}
 
-	Axis(Index length) noexcept : length(length), n(new Real[length]) {
+	/**
+	 * Ensures that this axis is the only owner of its ticks.
+	 */
+	void detach() {
+		if(storage.use_count() > 1) {
+			std::shared_ptr<Real> copy = allocate(length);
+			std::memcpy(copy.get(), n, sizeof(Real) * length);
+			storage = std::move(copy);
+			n = storage.get();
+		}
+	}
+
+	Axis() noexcept : length(0), n(nullptr), uniformSpacing(false) {
+	}
+
+	Axis(Index length) noexcept : length(length), storage(allocate(length)),
+			n(storage.get()), uniformSpacing(false) {
 	}
 
 	template <typename T>
 	inline void initialize(const T &list) {
 		length = list.size();
-		n = new Real[length];
+		storage = allocate(length);
+		n = storage.get();
+		uniformSpacing = false;
 
 		assert(length > 0);
 
@@ -113,7 +142,8 @@ public:
 	 * @param length The number of ticks.
 	 */
 	Axis(const Real *ticks, Index length) : length(length),
-			n(new Real[length]) {
+			storage(allocate(length)), n(storage.get()),
+			uniformSpacing(false) {
 		assert(length > 0);
 		std::memcpy(n, ticks, sizeof(Real) * length);
 	}
@@ -123,51 +153,52 @@ public:
 	 * @param ticks The ticks.
 	 */
 	Axis(const Vector &ticks) noexcept : length(ticks.size()),
-			n(new Real[length]) {
+			storage(allocate(length)), n(storage.get()),
+			uniformSpacing(false) {
 		assert(length > 0);
 		std::memcpy(n, ticks.data(), sizeof(Real) * length);
 	}
 
 	Axis(const Axis &that) noexcept : length(that.length),
-			n(new Real[length]) {
-		std::memcpy(n, that.n, length * sizeof(Real));
+			storage(that.storage), n(that.n),
+			uniformSpacing(that.uniformSpacing) {
 	}
 
-	Axis(Axis &&that) noexcept : length(that.length), n(that.n) {
+	Axis(Axis &&that) noexcept : length(that.length),
+			storage(std::move(that.storage)), n(that.n),
+			uniformSpacing(that.uniformSpacing) {
+		that.length = 0;
 		that.n = nullptr;
 	}
 
-	~Axis() {
-		delete [] n;
-		n = nullptr;
-	}
-
 	Axis &operator=(const Axis &that) & noexcept {
 		length = that.length;
-
-		Real *p = n;
-		n = new Real[length];
-		std::memcpy(n, that.n, length * sizeof(Real));
-
-		delete [] p;
-		p = nullptr;
+		storage = that.storage;
+		n = that.n;
+		uniformSpacing = that.uniformSpacing;
 
 		return *this;
 	}
 
 	Axis &operator=(Axis &&that) & noexcept {
 		length = that.length;
+		storage = std::move(that.storage);
 		n = that.n;
+		uniformSpacing = that.uniformSpacing;
+		that.length = 0;
 		that.n = nullptr;
 
 		return *this;
 	}
 
 	/**
-	 * Return a (non-const) reference to a node by index.
+	 * Return a (non-const) reference to a node by index. If the ticks are
+	 * shared with another axis, they are copied first; prefer the const
+	 * overload for reading.
 	 * @param i The index.
 	 */
 	Real &operator[](Index i) {
+		detach();
 		return n[i];
 	}
 
@@ -193,6 +224,16 @@ public:
 		return length;
 	}
 
+	/**
+	 * @return True if and only if the ticks on this axis are known to be
+	 *         evenly spaced (e.g. the axis was created by Axis::uniform or
+	 *         Axis::range). Locating a point on such an axis takes
+	 *         constant time.
+	 */
+	bool isUniform() const {
+		return uniformSpacing;
+	}
+
 	/**
 	 * Creates an axis with ticks spaced by a step-size.
 	 * Similar to MATLAB's colon notation with begin:step:end.
@@ -207,6 +248,7 @@ public:
 		for(Index i = 0; i < axis.length; ++i) {
 			axis.n[i] = begin + step * i;
 		}
+		axis.uniformSpacing = true;
 		return axis;
 	}
 
@@ -222,6 +264,7 @@ public:
 		for(Index i = 0; i < points; ++i) {
 			axis.n[i] = begin + dx * i;
 		}
+		axis.uniformSpacing = true;
 		return axis;
 	}
 
@@ -319,6 +362,7 @@ public:
 	 */
 	friend Axis &&operator*(Axis &&axis, Real c) {
 		assert(c != 0.);
+		axis.detach();
 		for(Index i = 0; i < axis.length; ++i) {
 			axis.n[i] *= c;
 		}
@@ -336,6 +380,7 @@ public:
 		for(Index i = 0; i < axis.length; ++i) {
 			newAxis.n[i] = axis.n[i] * c;
 		}
+		newAxis.uniformSpacing = axis.uniformSpacing;
 		return newAxis;
 	}
 
@@ -363,6 +408,7 @@ public:
 	* @param c The constant.
 	*/
 	friend Axis &&operator+(Axis &&axis, Real c) {
+		axis.detach();
 		for(Index i = 0; i < axis.length; ++i) {
 			axis.n[i] += c;
 		}
@@ -379,6 +425,7 @@ public:
 		for(Index i = 0; i < axis.length; ++i) {
 			newAxis.n[i] = axis.n[i] + c;
 		}
+		newAxis.uniformSpacing = axis.uniformSpacing;
 		return newAxis;
 	}
 
@@ -1,11 +1,78 @@
 #ifndef QUANT_PDE_CORE_BDF_HPP
 #define QUANT_PDE_CORE_BDF_HPP
 
+#include <algorithm> // std::max
+#include <cmath>     // std::abs
+
 namespace QuantPDE {
 
+/** @cond QUANT_PDE_HIDDEN */
+constexpr Real bdfSelect(size_t) {
+	return 0.;
+}
+
+template <typename ...Ts>
+constexpr Real bdfSelect(size_t j, int head, Ts ...tail) {
+	return j == 0 ? head : bdfSelect(j - 1, tail...);
+}
+/** @endcond */
+
+/**
+ * A table of BDF coefficients for a constant timestep \f$\Delta t\f$,
+ * normalized so that the new iterand solves
+ * \f$
+ * \left( I + \beta \Delta t A \right) v^{n+1}
+ * = \sum_{j} \alpha_j v^{n-j} + \beta \Delta t b
+ * \f$.
+ * @tparam Denominator The common denominator of all coefficients.
+ * @tparam Beta The numerator of \f$\beta\f$.
+ * @tparam Alphas The numerators of the \f$\alpha_j\f$, most recent first.
+ */
+template <int Denominator, int Beta, int ...Alphas>
+struct BDFCoefficientTable {
+	/**
+	 * @return The scaling applied to the timestep.
+	 */
+	static constexpr Real beta() {
+		return (Real) Beta / Denominator;
+	}
+
+	/**
+	 * @param j The lag (0 is the most recent iterand).
+	 * @return The weight applied to the j-th most recent iterand.
+	 */
+	static constexpr Real alpha(size_t j) {
+		return bdfSelect(j, Alphas...) / Denominator;
+	}
+};
+
+/**
+ * Constant timestep BDF coefficients, selected by order.
+ * @tparam Order The order of the BDF method.
+ */
+template <size_t Order>
+struct BDFConstantCoefficients;
+
+/** @cond QUANT_PDE_HIDDEN */
+template <> struct BDFConstantCoefficients<1>
+		: BDFCoefficientTable<  1,  1,   1                         > {};
+template <> struct BDFConstantCoefficients<2>
+		: BDFCoefficientTable<  3,  2,   4,   -1                   > {};
+template <> struct BDFConstantCoefficients<3>
+		: BDFCoefficientTable< 11,  6,  18,   -9,   2              > {};
+template <> struct BDFConstantCoefficients<4>
+		: BDFCoefficientTable< 25, 12,  48,  -36,  16,  -3         > {};
+template <> struct BDFConstantCoefficients<5>
+		: BDFCoefficientTable<137, 60, 300, -300, 200, -75, 12     > {};
+template <> struct BDFConstantCoefficients<6>
+		: BDFCoefficientTable<147, 60, 360, -450, 400, -225, 72, -10> {};
+/** @endcond */
+
 template <bool Forward, size_t Lookback>
 class BDFBase : public IterationNode {
 
+	bool constantTimestep;
+
 	inline Real difference(Real t1, Real t0) const {
 		const Real dt = Forward ? t1 - t0 : t0 - t1;
 		assert(dt > QuantPDE::epsilon);
@@ -17,12 +84,68 @@ protected:
 	const DomainBase &domain;
 	LinearSystem &op;
 
+	/**
+	 * @return True if and only if this is attached to a constant stepper
+	 *         and the last Order steps (including the one ending at t)
+	 *         have the same size. The last step before an event can be
+	 *         shortened by the stepper, in which case this is false.
+	 */
+	template <size_t Order>
+	inline bool isConstantTimestep(Real t) const {
+		if(!constantTimestep) {
+			return false;
+		}
+
+		// Ticks are accumulated by the stepper; allow for roundoff
+		const Real slack = 8. * QuantPDE::epsilon * std::max(
+				std::abs(t), std::abs(this->time(Order - 1)));
+
+		const Real h = difference(t, this->time(0));
+		for(size_t j = 1; j < Order; ++j) {
+			const Real hj = difference(this->time(j - 1),
+					this->time(j));
+			if(std::abs(hj - h) > slack) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template <size_t Order>
+	inline Matrix _AConstant(Real t) {
+		typedef BDFConstantCoefficients<Order> C;
+		const Real h = difference(t, this->time(0));
+
+		return
+			this->domain.identity()
+			+ (C::beta() * h) * op.A(t)
+		;
+	}
+
+	template <size_t Order>
+	inline Vector _bConstant(Real t) {
+		typedef BDFConstantCoefficients<Order> C;
+		const Real h = difference(t, this->time(0));
+
+		Vector b = C::alpha(0) * this->iterand(0);
+		for(size_t j = 1; j < Order; ++j) {
+			b += C::alpha(j) * this->iterand(j);
+		}
+
+		return b + (C::beta() * h) * op.b(t);
+	}
+
 	inline bool _isATheSame1() const {
 		return false;
 	}
 
 	inline bool _isATheSame2() const {
-		return this->isTimestepTheSame() && op.isATheSame();
+		// The left hand side is (I + c * dt * A). For multistep methods,
+		// c * dt depends on the entire step history, so it is only known
+		// to be unchanged under a constant stepper.
+		return this->isTimestepTheSame() && op.isATheSame()
+				&& (Lookback == 1 || constantTimestep);
 	}
 
 #define QUANT_PDE_TMP \
@@ -73,23 +196,23 @@ ans =
 	const Real hh = (h0*h1)/(h0 + h1); \
 
 	inline Matrix _A2(Real t2) {
+		if(isConstantTimestep<2>(t2)) {
+			return _AConstant<2>(t2);
+		}
+
 		QUANT_PDE_TMP;
 
 		return
 			this->domain.identity()
 			+ hh * op.A(t2)
 		;
-
-		// Constant timestep case:
-		/*
-		return
-			domain->identity()
-			- 2. / 3. * op->A(t2) * dt()
-		;
-		*/
 	}
 
 	inline Vector _b2(Real t2) {
+		if(isConstantTimestep<2>(t2)) {
+			return _bConstant<2>(t2);
+		}
+
 		QUANT_PDE_TMP;
 
 		const Vector
@@ -106,14 +229,6 @@ ans =
 				+ op.b(t2)
 			) * hh
 		;
-
-		// Constant timestep case:
-		/*
-		return (
-			  4. * v1
-			- 1. * v0
-		) / 3.;
-		*/
 	}
 
 #undef QUANT_PDE_TMP
@@ -148,23 +263,23 @@ ans =
 	const Real hh = (h0*h1*h2)/(h0*h1 + h0*h2 + h1*h2);
 
 	inline Matrix _A3(Real t3) {
+		if(isConstantTimestep<3>(t3)) {
+			return _AConstant<3>(t3);
+		}
+
 		QUANT_PDE_TMP;
 
 		return
 			this->domain.identity()
 			+ hh * op.A(t3)
 		;
-
-		// Constant timestep case:
-		/*
-		return
-			domain->identity()
-			- 6. / 11. * op->A(t3) * dt()
-		;
-		*/
 	}
 
 	inline Vector _b3(Real t3) {
+		if(isConstantTimestep<3>(t3)) {
+			return _bConstant<3>(t3);
+		}
+
 		QUANT_PDE_TMP;
 
 		const Vector
@@ -181,15 +296,6 @@ ans =
 				+ op.b(t3)
 			) * hh
 		;
-
-		// Constant timestep case:
-		/*
-		return (
-			  18. * v2
-			- 9.  * v1
-			+ 2.  * v0
-		) / 11.;
-		*/
 	}
 
 #undef QUANT_PDE_TMP
@@ -228,23 +334,23 @@ ans =
 	const Real hh = (h0*h1*h2*h3)/(h0*h1*h2 + h0*h1*h3 + h0*h2*h3 + h1*h2*h3);
 
 	inline Matrix _A4(Real t4) {
+		if(isConstantTimestep<4>(t4)) {
+			return _AConstant<4>(t4);
+		}
+
 		QUANT_PDE_TMP;
 
 		return
 			this->domain.identity()
 			+ hh * op.A(t4)
 		;
-
-
-		// Constant timestep case:
-		/*
-		return
-			domain->identity()
-			- 12. / 25. * op->A(t4) * dt();
-		*/
 	}
 
 	inline Vector _b4(Real t4) {
+		if(isConstantTimestep<4>(t4)) {
+			return _bConstant<4>(t4);
+		}
+
 		QUANT_PDE_TMP;
 
 		const Vector
@@ -263,16 +369,6 @@ ans =
 				+ op.b(t4)
 			) * hh
 		;
-
-		// Constant timestep case:
-		/*
-		return (
-			  48. * v3
-			- 36. * v2
-			+ 16. * v1
-			- 3.  * v0
-		) / 25.;
-		*/
 	}
 
 #undef QUANT_PDE_TMP
@@ -315,23 +411,23 @@ ans =
 	const Real hh = (h0*h1*h2*h3*h4)/(h0*h1*h2*h3 + h0*h1*h2*h4 + h0*h1*h3*h4 + h0*h2*h3*h4 + h1*h2*h3*h4);
 
 	inline Matrix _A5(Real t5) {
+		if(isConstantTimestep<5>(t5)) {
+			return _AConstant<5>(t5);
+		}
+
 		QUANT_PDE_TMP;
 
 		return
 			this->domain.identity()
 			+ hh * op.A(t5)
 		;
-
-		// Constant timestep case:
-		/*
-		return
-			domain->identity()
-			- 60. / 137. * op->A(t5) * dt()
-		;
-		*/
 	}
 
 	inline Vector _b5(Real t5) {
+		if(isConstantTimestep<5>(t5)) {
+			return _bConstant<5>(t5);
+		}
+
 		QUANT_PDE_TMP;
 
 		const Vector
@@ -352,17 +448,6 @@ ans =
 				+ op.b(t5)
 			) * hh
 		;
-
-		// Constant timestep case:
-		/*
-		return (
-			  300. * v4
-			- 300. * v3
-			+ 200. * v2
-			- 75.  * v1
-			+ 12.  * v0
-		) / 137.;
-		*/
 	}
 
 #undef QUANT_PDE_TMP
@@ -409,23 +494,23 @@ ans =
 	const Real hh = (h0*h1*h2*h3*h4*h5)/(h0*h1*h2*h3*h4 + h0*h1*h2*h3*h5 + h0*h1*h2*h4*h5 + h0*h1*h3*h4*h5 + h0*h2*h3*h4*h5 + h1*h2*h3*h4*h5);
 
 	inline Matrix _A6(Real t6) {
+		if(isConstantTimestep<6>(t6)) {
+			return _AConstant<6>(t6);
+		}
+
 		QUANT_PDE_TMP;
 
 		return
 			this->domain.identity()
 			+ hh * op.A(t6)
 		;
-
-		// Constant timestep case:
-		/*
-		return
-			domain->identity()
-			- 60. / 147. * op->A(t) * dt()
-		;
-		*/
 	}
 
 	inline Vector _b6(Real t6) {
+		if(isConstantTimestep<6>(t6)) {
+			return _bConstant<6>(t6);
+		}
+
 		QUANT_PDE_TMP;
 
 		const Vector
@@ -448,18 +533,6 @@ ans =
 				+ op.b(t6)
 			) * hh
 		;
-
-		// Constant timestep case:
-		/*
-		return (
-			  360. * v5
-			- 450. * v4
-			+ 400. * v3
-			- 225. * v2
-			+ 72.  * v1
-			- 10.  * v0
-		) / 147.;
-		*/
 	}
 
 #undef QUANT_PDE_TMP
@@ -471,11 +544,25 @@ public:
 		D &domain,
 		LinearSystem &op
 	) noexcept :
+		constantTimestep(false),
 		domain(domain),
 		op(op)
 	{
 	}
 
+	/**
+	 * Associates with this linear system an iterative method. If the
+	 * method is a ConstantStepper, the constant timestep coefficients are
+	 * used whenever the step history allows it.
+	 * @param iteration The iterative method.
+	 * @see QuantPDE::BDFConstantCoefficients
+	 */
+	virtual void setIteration(Iteration &iteration) {
+		IterationNode::setIteration(iteration);
+		constantTimestep = dynamic_cast<ConstantStepper<Forward> *>(
+				&iteration) != nullptr;
+	}
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////
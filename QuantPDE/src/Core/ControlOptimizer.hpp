@@ -0,0 +1,533 @@
+#ifndef QUANT_PDE_CORE_CONTROL_OPTIMIZER_HPP
+#define QUANT_PDE_CORE_CONTROL_OPTIMIZER_HPP
+
+#include <array>      // std::array
+#include <cassert>    // assert
+#include <cmath>      // std::abs, std::sqrt
+#include <functional> // std::function
+#include <limits>     // std::numeric_limits
+#include <utility>    // std::forward
+#include <vector>     // std::vector
+
+namespace QuantPDE {
+
+/**
+ * Finds the optimal control at a single node. The objective is a function of
+ * the control alone (e.g. the residual of a single row of a controlled linear
+ * system), which is minimized.
+ *
+ * Implementations should be stateless, since they may be called concurrently
+ * for distinct nodes.
+ *
+ * @tparam ControlDimension The dimension of the control.
+ */
+template <Index ControlDimension>
+class ControlOptimizer {
+
+public:
+
+	/**
+	 * A control.
+	 */
+	typedef std::array<Real, ControlDimension> Control;
+
+	/**
+	 * The function to minimize.
+	 */
+	typedef std::function<Real (const Control &)> Objective;
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~ControlOptimizer() {
+	}
+
+	/**
+	 * Minimizes the objective.
+	 * @param time The time.
+	 * @param row The index of the node.
+	 * @param iterand The current iterand (e.g. to compute derivatives).
+	 * @param objective The function to minimize.
+	 * @param control On output, the optimal control.
+	 * @return The minimum.
+	 */
+	virtual Real minimize(Real time, Index row, const Vector &iterand,
+			const Objective &objective, Control &control) const = 0;
+
+};
+
+typedef ControlOptimizer<1> ControlOptimizer1;
+typedef ControlOptimizer<2> ControlOptimizer2;
+typedef ControlOptimizer<3> ControlOptimizer3;
+
+/**
+ * Searches every node of a grid of controls. The first node attaining the
+ * minimum is returned.
+ */
+template <Index ControlDimension>
+class ExhaustiveSearch final : public ControlOptimizer<ControlDimension> {
+
+	typedef ControlOptimizer<ControlDimension> Base;
+
+	RectilinearGrid<ControlDimension> grid;
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param grid The controls to search.
+	 */
+	template <typename G>
+	ExhaustiveSearch(G &&grid) noexcept : grid(std::forward<G>(grid)) {
+	}
+
+	virtual Real minimize(Real, Index, const Vector &,
+			const typename Base::Objective &objective,
+			typename Base::Control &control) const {
+		Real best = std::numeric_limits<Real>::infinity();
+		for(auto node : grid) {
+			typename Base::Control candidate;
+			for(Index d = 0; d < ControlDimension; ++d) {
+				candidate[d] = node[d];
+			}
+
+			const Real value = objective(candidate);
+			if(value < best) {
+				best = value;
+				control = candidate;
+			}
+		}
+		return best;
+	}
+
+};
+
+typedef ExhaustiveSearch<1> ExhaustiveSearch1;
+typedef ExhaustiveSearch<2> ExhaustiveSearch2;
+typedef ExhaustiveSearch<3> ExhaustiveSearch3;
+
+/**
+ * Brackets the optimal control by searching a coarse grid of controls, and
+ * then refines it by one-dimensional searches along each axis (within the
+ * cells adjacent to the best coarse node). The refined control is only
+ * accepted if it improves on the best coarse node.
+ *
+ * If the objective is unimodal in each cell, this costs
+ * \f$O\left(\left|\text{coarse grid}\right| + \log(1 / \epsilon)\right)\f$
+ * evaluations for a tolerance \f$\epsilon\f$, as opposed to
+ * \f$O(1 / \epsilon)\f$ for an exhaustive search.
+ *
+ * @see QuantPDE::GoldenSectionSearch
+ * @see QuantPDE::BrentSearch
+ */
+template <Index ControlDimension>
+class BracketingSearch : public ControlOptimizer<ControlDimension> {
+
+	typedef ControlOptimizer<ControlDimension> Base;
+
+	RectilinearGrid<ControlDimension> grid;
+	int sweeps;
+
+protected:
+
+	Real tolerance;
+
+	/**
+	 * Minimizes a function of one variable on an interval.
+	 * @param f The function.
+	 * @param a The left endpoint.
+	 * @param b The right endpoint.
+	 * @param x On output, the minimizer.
+	 * @return The minimum.
+	 */
+	virtual Real minimize1(const std::function<Real (Real)> &f, Real a,
+			Real b, Real &x) const = 0;
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param grid The coarse grid of controls used for bracketing.
+	 * @param tolerance The (absolute) tolerance on each control.
+	 * @param sweeps The number of passes over the axes (only relevant for
+	 *               multidimensional controls).
+	 */
+	template <typename G>
+	BracketingSearch(G &&grid, Real tolerance, int sweeps = 1) noexcept
+			: grid(std::forward<G>(grid)), sweeps(sweeps),
+			tolerance(tolerance) {
+		assert(tolerance > 0.);
+		assert(sweeps > 0);
+	}
+
+	virtual Real minimize(Real, Index, const Vector &,
+			const typename Base::Objective &objective,
+			typename Base::Control &control) const {
+		// Bracket
+		Real best = std::numeric_limits<Real>::infinity();
+		Index k = 0, optimal = -1;
+		for(auto node : grid) {
+			typename Base::Control candidate;
+			for(Index d = 0; d < ControlDimension; ++d) {
+				candidate[d] = node[d];
+			}
+
+			const Real value = objective(candidate);
+			if(value < best) {
+				best = value;
+				control = candidate;
+				optimal = k;
+			}
+
+			++k;
+		}
+
+		if(optimal < 0) {
+			// The objective is nowhere finite
+			return best;
+		}
+
+		// Refine
+		const std::array<Index, ControlDimension> indices =
+				grid.indices(optimal);
+		for(int s = 0; s < sweeps; ++s) {
+			for(Index d = 0; d < ControlDimension; ++d) {
+				const Axis &axis = grid[d];
+				const Index i = indices[d];
+				const Real a = axis[i > 0 ? i - 1 : i];
+				const Real b = axis[i < axis.size() - 1 ? i + 1
+						: i];
+				if(a >= b) {
+					continue;
+				}
+
+				typename Base::Control candidate = control;
+				auto f = [&] (Real x) {
+					candidate[d] = x;
+					return objective(candidate);
+				};
+
+				Real x;
+				const Real value = minimize1(f, a, b, x);
+				if(value < best) {
+					best = value;
+					control[d] = x;
+				}
+			}
+		}
+
+		return best;
+	}
+
+};
+
+/**
+ * Bracketing search refined by golden-section search.
+ * @see QuantPDE::BracketingSearch
+ */
+template <Index ControlDimension>
+class GoldenSectionSearch final : public BracketingSearch<ControlDimension> {
+
+	virtual Real minimize1(const std::function<Real (Real)> &f, Real a,
+			Real b, Real &x) const {
+		const Real r = (std::sqrt(5.) - 1.) / 2.;
+
+		Real c = b - r * (b - a), d = a + r * (b - a);
+		Real fc = f(c), fd = f(d);
+		while(b - a > this->tolerance) {
+			if(fc < fd) {
+				b = d;
+				d = c;
+				fd = fc;
+				c = b - r * (b - a);
+				fc = f(c);
+			} else {
+				a = c;
+				c = d;
+				fc = fd;
+				d = a + r * (b - a);
+				fd = f(d);
+			}
+		}
+
+		if(fc < fd) {
+			x = c;
+			return fc;
+		}
+		x = d;
+		return fd;
+	}
+
+public:
+
+	template <typename G>
+	GoldenSectionSearch(G &&grid, Real tolerance, int sweeps = 1) noexcept
+			: BracketingSearch<ControlDimension>(
+			std::forward<G>(grid), tolerance, sweeps) {
+	}
+
+};
+
+typedef GoldenSectionSearch<1> GoldenSectionSearch1;
+typedef GoldenSectionSearch<2> GoldenSectionSearch2;
+typedef GoldenSectionSearch<3> GoldenSectionSearch3;
+
+/**
+ * Bracketing search refined by Brent's method (golden-section search
+ * accelerated by successive parabolic interpolation).
+ * @see QuantPDE::BracketingSearch
+ */
+template <Index ControlDimension>
+class BrentSearch final : public BracketingSearch<ControlDimension> {
+
+	virtual Real minimize1(const std::function<Real (Real)> &f, Real a,
+			Real b, Real &x) const {
+		const Real c = (3. - std::sqrt(5.)) / 2.;
+		const Real eps = std::sqrt(
+				std::numeric_limits<Real>::epsilon() );
+
+		// x: best so far, w: second best, v: previous value of w
+		x = a + c * (b - a);
+		Real w = x, v = x;
+		Real fx = f(x), fw = fx, fv = fx;
+		Real d = 0., e = 0.;
+
+		while(true) {
+			const Real m = (a + b) / 2.;
+			const Real tol = eps * std::abs(x) + this->tolerance / 3.;
+			const Real t2 = 2. * tol;
+
+			if(std::abs(x - m) <= t2 - (b - a) / 2.) {
+				break;
+			}
+
+			Real p = 0., q = 0., r = 0.;
+			if(std::abs(e) > tol) {
+				// Fit parabola
+				r = (x - w) * (fx - fv);
+				q = (x - v) * (fx - fw);
+				p = (x - v) * q - (x - w) * r;
+				q = 2. * (q - r);
+				if(q > 0.) {
+					p = -p;
+				} else {
+					q = -q;
+				}
+				r = e;
+				e = d;
+			}
+
+			if(std::abs(p) < std::abs(q * r / 2.)
+					&& p > q * (a - x) && p < q * (b - x)) {
+				// Parabolic interpolation step
+				d = p / q;
+				const Real u = x + d;
+				if(u - a < t2 || b - u < t2) {
+					d = x < m ? tol : -tol;
+				}
+			} else {
+				// Golden-section step
+				e = (x < m ? b : a) - x;
+				d = c * e;
+			}
+
+			const Real u = x + (std::abs(d) >= tol ? d
+					: (d > 0. ? tol : -tol));
+			const Real fu = f(u);
+
+			if(fu <= fx) {
+				if(u < x) {
+					b = x;
+				} else {
+					a = x;
+				}
+				v = w; fv = fw;
+				w = x; fw = fx;
+				x = u; fx = fu;
+			} else {
+				if(u < x) {
+					a = u;
+				} else {
+					b = u;
+				}
+				if(fu <= fw || w == x) {
+					v = w; fv = fw;
+					w = u; fw = fu;
+				} else if(fu <= fv || v == x || v == w) {
+					v = u; fv = fu;
+				}
+			}
+		}
+
+		return fx;
+	}
+
+public:
+
+	template <typename G>
+	BrentSearch(G &&grid, Real tolerance, int sweeps = 1) noexcept
+			: BracketingSearch<ControlDimension>(
+			std::forward<G>(grid), tolerance, sweeps) {
+	}
+
+};
+
+typedef BrentSearch<1> BrentSearch1;
+typedef BrentSearch<2> BrentSearch2;
+typedef BrentSearch<3> BrentSearch3;
+
+/**
+ * A control known in closed form (e.g. from the first-order conditions). The
+ * closed form is a function of the time, the index of the node and the current
+ * iterand, so that it can depend on (finite difference approximations of) the
+ * derivatives of the solution.
+ */
+template <Index ControlDimension>
+class ClosedFormControl final : public ControlOptimizer<ControlDimension> {
+
+	typedef ControlOptimizer<ControlDimension> Base;
+
+public:
+
+	/**
+	 * The closed form.
+	 */
+	typedef std::function<typename Base::Control (Real, Index,
+			const Vector &)> Formula;
+
+private:
+
+	Formula formula;
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param formula The closed form.
+	 */
+	template <typename F>
+	ClosedFormControl(F &&formula) noexcept
+			: formula(std::forward<F>(formula)) {
+	}
+
+	virtual Real minimize(Real time, Index row, const Vector &iterand,
+			const typename Base::Objective &objective,
+			typename Base::Control &control) const {
+		control = formula(time, row, iterand);
+		return objective(control);
+	}
+
+};
+
+typedef ClosedFormControl<1> ClosedFormControl1;
+typedef ClosedFormControl<2> ClosedFormControl2;
+typedef ClosedFormControl<3> ClosedFormControl3;
+
+/**
+ * Lists the nodes of a grid of controls that lie within a fixed number of
+ * ticks (along each axis) of a given node, e.g. the optimal control at the
+ * previous timestep. This is used to warm-start a search for the optimal
+ * control: if the best node in the neighbourhood is not on its boundary, it is
+ * (assuming the objective is unimodal) the best node overall. Otherwise, the
+ * whole grid has to be searched.
+ */
+template <Index ControlDimension>
+class NeighbourhoodSearch final {
+
+	const RectilinearGrid<ControlDimension> *grid;
+	int radius;
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param grid The grid of controls.
+	 * @param radius The number of ticks to search on either side of the
+	 *               centre along each axis (at least 1).
+	 */
+	NeighbourhoodSearch(const RectilinearGrid<ControlDimension> &grid,
+			int radius = 1) noexcept : grid(&grid), radius(radius) {
+		assert(radius > 0);
+	}
+
+	/**
+	 * Lists the nodes in the neighbourhood of a node in increasing order.
+	 * @param centre The index of the node.
+	 * @param nodes On output, the indices of the nodes in the
+	 *              neighbourhood.
+	 */
+	void neighbourhood(Index centre, std::vector<Index> &nodes) const {
+		nodes.clear();
+
+		const std::array<Index, ControlDimension> c =
+				grid->indices(centre);
+
+		Index lo[ControlDimension], hi[ControlDimension];
+		Index strides[ControlDimension];
+		for(Index d = 0; d < ControlDimension; ++d) {
+			const Index n = (*grid)[d].size();
+			lo[d] = c[d] - radius > 0 ? c[d] - radius : 0;
+			hi[d] = c[d] + radius < n - 1 ? c[d] + radius : n - 1;
+			strides[d] = d == 0 ? 1 : strides[d - 1]
+					* (*grid)[d - 1].size();
+		}
+
+		// The first axis varies fastest, so that the nodes are listed
+		// in increasing order
+		Index i[ControlDimension];
+		for(Index d = 0; d < ControlDimension; ++d) {
+			i[d] = lo[d];
+		}
+		while(true) {
+			Index index = 0;
+			for(Index d = 0; d < ControlDimension; ++d) {
+				index += i[d] * strides[d];
+			}
+			nodes.push_back(index);
+
+			Index d = 0;
+			while(d < ControlDimension && i[d] == hi[d]) {
+				i[d] = lo[d];
+				++d;
+			}
+			if(d == ControlDimension) {
+				break;
+			}
+			++i[d];
+		}
+	}
+
+	/**
+	 * @param centre The index of the node at the centre of the
+	 *               neighbourhood.
+	 * @param node The index of a node in the neighbourhood.
+	 * @return False if and only if the node lies on a side of the
+	 *         neighbourhood that is not also a side of the grid.
+	 */
+	bool isInterior(Index centre, Index node) const {
+		const std::array<Index, ControlDimension> c =
+				grid->indices(centre);
+		const std::array<Index, ControlDimension> m =
+				grid->indices(node);
+
+		for(Index d = 0; d < ControlDimension; ++d) {
+			const Index n = (*grid)[d].size();
+			if( (m[d] <= c[d] - radius && m[d] > 0)
+					|| (m[d] >= c[d] + radius
+					&& m[d] < n - 1) ) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+};
+
+typedef NeighbourhoodSearch<1> NeighbourhoodSearch1;
+typedef NeighbourhoodSearch<2> NeighbourhoodSearch2;
+typedef NeighbourhoodSearch<3> NeighbourhoodSearch3;
+
+}
+
+#endif
@@ -14,8 +14,8 @@ namespace QuantPDE {
  * Let \f$\Delta t\equiv t^1 - t^0\f$ where \f$t^1\f$ is the current time and
  * \f$t^0\f$ is the previous time. This creates the linear system
  * \f[ \left[I + A(t^1)\Delta t/2\right]\mathbf{x}^1 = \left[I - A(t^0)\Delta
- * t/2\right]\mathbf{x}^0 + \left[b\left(t^1\right) + b\left(t^0\right)\right]/2
- * \f]
+ * t/2\right]\mathbf{x}^0 + \left[b\left(t^1\right) + b\left(t^0\right)\right]
+ * \Delta t/2 \f]
  *
  * @tparam ThetaInverse 1 for implicit method, 2 for Crank-Nicolson, and
  *                      std::numeric_limits<Real>::infinity() for infinity.
@@ -74,7 +74,8 @@ class CrankNicolson : public IterationNode {
 		return (
 			this->domain.identity()
 			- A * (1-theta) * dt()
-		) * v0 + ( theta * system.b(t1) + (1-theta) * system.b(t0) );
+		) * v0 + ( theta * system.b(t1) + (1-theta) * system.b(t0) )
+				* dt();
 	}
 
 public:
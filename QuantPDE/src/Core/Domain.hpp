@@ -1,19 +1,34 @@
 #ifndef QUANT_PDE_CORE_DOMAIN_HPP
 #define QUANT_PDE_CORE_DOMAIN_HPP
 
+#include <algorithm>   // std::max
 #include <array>       // std::array
 #include <cassert>     // assert
+#include <cmath>       // std::abs
+#include <cstdint>     // std::intmax_t
 #include <cstdlib>     // size_t
 #include <iostream>    // std::ostream
 #include <iomanip>     // std::setw
 #include <memory>      // std::shared_ptr, std::unique_ptr
 #include <type_traits> // std::conditional, std::enable_if, std::is_same
 #include <utility>     // std::forward, std::move
+#include <vector>      // std::vector
 
 namespace QuantPDE {
 
 template <Index Dimension> class InterpolantFactoryWrapper;
-//template <Index Dimension> class Refiner;
+template <Index Dimension> class Refiner;
+
+/**
+ * A list of points, one per row. Each column holds one coordinate of all of the
+ * points and is contiguous in memory.
+ */
+template <Index Dimension>
+using Points = Eigen::Matrix<Real, Eigen::Dynamic, Dimension>;
+
+typedef Points<1> Points1;
+typedef Points<2> Points2;
+typedef Points<3> Points3;
 
 /**
  * A (finite) set of points in some space.
@@ -529,8 +544,63 @@ QUANT_PDE_TMP(NON_CONST)
 	template <typename F>
 	Vector image(F &&function) const;
 
+	/**
+	 * Visits the nodes of this domain in blocks of consecutive nodes,
+	 * splitting them into contiguous chunks, one per thread (see
+	 * QuantPDE::parallelFor). For each block, f(begin, end, points) is
+	 * called, where the k-th row of points holds the coordinates of the
+	 * node begin + k. Since each coordinate of the block is contiguous in
+	 * memory, f can process it with vectorized code, e.g.
+	 * \code{.cpp}
+	 * Vector v = D.vector();
+	 * D.parallelForEachNode( [&] (Index begin, Index end,
+	 * 		const Points2 &points) {
+	 * 	v.segment(begin, end - begin) = points.col(0).array()
+	 * 			* points.col(1).array();
+	 * }, 0);
+	 * \endcode
+	 * @param f A function on a block of nodes. It is called concurrently
+	 *          on distinct blocks, and so must be safe to do so if threads
+	 *          is not 1.
+	 * @param threads The number of threads (0 to use hardwareThreads()).
+	 */
+	template <typename F>
+	void parallelForEachNode(F &&f, unsigned threads = 1) const;
+
+	/**
+	 * Same as image, but evaluates the function on multiple threads.
+	 * @param function A function. It is called concurrently, and so must be
+	 *                 safe to do so if threads is not 1.
+	 * @param threads The number of threads (0 to use hardwareThreads()).
+	 * @return The image of a function on this domain as a vector.
+	 * @see QuantPDE::Domain::image
+	 * @see QuantPDE::Domain::parallelForEachNode
+	 */
+	template <typename F>
+	Vector parallelImage(F &&function, unsigned threads = 1) const;
+
+	/**
+	 * Fills the rows of points with the coordinates of the nodes begin,
+	 * ..., end - 1. Subclasses should override this when consecutive nodes
+	 * can be enumerated more cheaply than by calls to coordinates(index).
+	 * @param begin The first node.
+	 * @param end One past the last node.
+	 * @param points A list with (end - begin) rows.
+	 */
+	virtual void blockCoordinates(Index begin, Index end,
+			Points<Dimension> &points) const {
+		for(Index k = begin; k < end; ++k) {
+			const std::array<Real, Dimension> x = coordinates(k);
+			for(Index d = 0; d < Dimension; ++d) {
+				points(k - begin, d) = x[d];
+			}
+		}
+	}
+
 	////////////////////////////////////////////////////////////////////////
 
+	// Domains are immutable; refiners create new domains instead (see
+	// QuantPDE::Refiner)
 	#if 0
 	/**
 	 * Refines the domain in-place.
@@ -566,6 +636,49 @@ Vector Domain<Dimension>::image(F &&function) const {
 	return v;
 }
 
+template <Index Dimension> template <typename F>
+void Domain<Dimension>::parallelForEachNode(F &&f, unsigned threads) const {
+	// Nodes per block; small enough for the coordinates of a block to fit
+	// in the cache
+	const Index block = 512;
+
+	const Index n = size();
+	if(threads == 0) {
+		threads = hardwareThreads();
+	}
+	const Index chunks = std::min<Index>(threads, (n + block - 1) / block);
+
+	parallelFor(0, chunks, chunks, [&] (Index k) {
+		const Index first = (Index) ( (std::intmax_t) n * k / chunks );
+		const Index last = (Index) (
+				(std::intmax_t) n * (k + 1) / chunks );
+
+		Points<Dimension> points;
+		for(Index begin = first; begin < last; begin += block) {
+			const Index end = std::min(last, begin + block);
+			points.resize(end - begin, Dimension);
+			blockCoordinates(begin, end, points);
+			f(begin, end, (const Points<Dimension> &) points);
+		}
+	});
+}
+
+template <Index Dimension> template <typename F>
+Vector Domain<Dimension>::parallelImage(F &&function, unsigned threads) const {
+	Vector v = vector();
+	parallelForEachNode( [&] (Index begin, Index end,
+			const Points<Dimension> &points) {
+		Real x[Dimension];
+		for(Index k = 0; k < end - begin; ++k) {
+			Unroll<Dimension>::apply([&] (Index d) {
+				x[d] = points(k, d);
+			});
+			v(begin + k) = packAndCall<Dimension>(function, x);
+		}
+	}, threads);
+	return v;
+}
+
 typedef Domain<1> Domain1;
 typedef Domain<2> Domain2;
 typedef Domain<3> Domain3;
@@ -662,7 +775,6 @@ typename D::VectorAccessorSHARED accessor(D &domain, F &&function,
 
 ////////////////////////////////////////////////////////////////////////////////
 
-#if 0
 /**
  * A routine used to refine a domain.
  */
@@ -695,6 +807,7 @@ public:
 
 };
 
+#if 0
 #define QUANT_PDE_REFINE_IN_PLACE(DERIVED_CLASS, REFINER)            \
 		do {                                                 \
 			(*this) = dynamic_cast<DERIVED_CLASS &&>(    \
@@ -839,20 +952,17 @@ class RectilinearGrid : public Domain<Dimension> {
 					"The number of arguments must be "
 					"consistent with the dimensions");
 
-			// TODO: Currently, we take the argument pack and unpack
-			//       it into an array. Each half of the array is
-			//       then packed and the member function is called.
-			//       Instead, we should split the pack directly.
-
-			Index idxs[] {indices...};
-
-			NaryMethodConst<Index, RectilinearGrid, Dimension,
-					Index> pointer
-					= &RectilinearGrid::index;
+			// The first half of the pack indexes the row, the
+			// second half the column
+			const Index idxs[] {indices...};
+			Index row[Dimension], column[Dimension];
+			for(int d = 0; d < Dimension; ++d) {
+				row[d] = idxs[d];
+				column[d] = idxs[Dimension + d];
+			}
 
-			Index i = packAndCall<Dimension>(*grid, pointer, idxs);
-			Index j = packAndCall<Dimension>(*grid, pointer,
-					idxs + Dimension);
+			Index i = grid->index(row);
+			Index j = grid->index(column);
 
 
 			return matrix->insert(i, j);
@@ -907,20 +1017,17 @@ class RectilinearGrid : public Domain<Dimension> {
 					"The number of arguments must be "
 					"consistent with the dimensions");
 
-			// TODO: Currently, we take the argument pack and unpack
-			//       it into an array. Each half of the array is
-			//       then packed and the member function is called.
-			//       Instead, we should split the pack directly.
-
-			Index idxs[] {indices...};
-
-			NaryMethodConst<Index, RectilinearGrid, Dimension,
-					Index> pointer
-					= &RectilinearGrid::index;
+			// The first half of the pack indexes the row, the
+			// second half the column
+			const Index idxs[] {indices...};
+			Index row[Dimension], column[Dimension];
+			for(int d = 0; d < Dimension; ++d) {
+				row[d] = idxs[d];
+				column[d] = idxs[Dimension + d];
+			}
 
-			Index i = packAndCall<Dimension>(*grid, pointer, idxs);
-			Index j = packAndCall<Dimension>(*grid, pointer,
-					idxs + Dimension);
+			Index i = grid->index(row);
+			Index j = grid->index(column);
 
 			entries.push_back( Entry(i, j, 0.) );
 			return entries.back().value();
@@ -976,20 +1083,17 @@ class RectilinearGrid : public Domain<Dimension> {
 					"The number of arguments must be "
 					"consistent with the dimensions");
 
-			// TODO: Currently, we take the argument pack and unpack
-			//       it into an array. Each half of the array is
-			//       then packed and the member function is called.
-			//       Instead, we should split the pack directly.
-
-			Index idxs[] {indices...};
-
-			NaryMethodConst<Index, RectilinearGrid, Dimension,
-					Index> pointer
-					= &RectilinearGrid::index;
+			// The first half of the pack indexes the row, the
+			// second half the column
+			const Index idxs[] {indices...};
+			Index row[Dimension], column[Dimension];
+			for(int d = 0; d < Dimension; ++d) {
+				row[d] = idxs[d];
+				column[d] = idxs[Dimension + d];
+			}
 
-			Index i = packAndCall<Dimension>(*grid, pointer, idxs);
-			Index j = packAndCall<Dimension>(*grid, pointer,
-					idxs + Dimension);
+			Index i = grid->index(row);
+			Index j = grid->index(column);
 
 			return M.insert(i, j);
 		}
@@ -1015,24 +1119,37 @@ class RectilinearGrid : public Domain<Dimension> {
 	void initialize() {
 		vsize = 1;
 
-		// TODO: Optimize (loop unroll)
-		for(Index i = 0; i < Dimension; ++i) {
+		Unroll<Dimension>::apply([&] (Index i) {
 			assert(this->axes[i].size() > 0);
+			this->strides[i] = vsize;
 			vsize *= this->axes[i].size();
-		}
+		});
 	}
 
 	////////////////////////////////////////////////////////////////////////
 
 	Index vsize;
+	Index strides[Dimension]; // Distance between adjacent ticks on each
+	                          // axis in the natural order
 	Axis axes[Dimension]; // Private constructor Axis()
 	                      // (Domain is a friend of Axis)
 
+	/**
+	 * Copies the axes, size, and strides of another grid.
+	 */
+	template <typename G>
+	void assign(G &&that) {
+		vsize = that.vsize;
+		Unroll<Dimension>::apply([&] (Index i) {
+			strides[i] = that.strides[i];
+			axes[i] = std::forward<G>(that).axes[i];
+		});
+	}
+
 	////////////////////////////////////////////////////////////////////////
 
 public:
 
-	#if 0
 	/**
 	 * Refines a rectilinear grid by refining each axis as follows: for each
 	 * two adjacent (distinct) ticks on the axis, a new tick is inserted
@@ -1044,33 +1161,76 @@ public:
 
 		virtual std::unique_ptr< Domain<Dimension> > refine(
 				const Domain<Dimension> &domain) const {
-			std::unique_ptr< Domain<Dimension> > pointer(
-					new RectilinearGrid());
+			const RectilinearGrid<Dimension> &original
+					= dynamic_cast<
+					const RectilinearGrid<Dimension> &>(
+					domain);
+
+			return std::unique_ptr< Domain<Dimension> >(
+					new RectilinearGrid(original.refined())
+			);
+		}
+
+	};
+
+	/**
+	 * Flags for the intervals between adjacent ticks on each axis. The i-th
+	 * flag of the k-th axis corresponds to the interval between its i-th
+	 * and (i+1)-th ticks.
+	 */
+	typedef std::array<std::vector<bool>, Dimension> IntervalFlags;
+
+	/**
+	 * Refines a rectilinear grid by inserting a new tick halfway between
+	 * two adjacent ticks only if the interval between them is flagged.
+	 * @see QuantPDE::RectilinearGrid::flagIntervals
+	 */
+	class NewTickInFlaggedIntervals : public Refiner<Dimension> {
+
+		IntervalFlags flags;
+
+	public:
 
+		/**
+		 * Constructor.
+		 * @param flags The intervals to refine.
+		 */
+		NewTickInFlaggedIntervals(IntervalFlags flags) noexcept
+				: flags(std::move(flags)) {
+		}
+
+		virtual std::unique_ptr< Domain<Dimension> > refine(
+				const Domain<Dimension> &domain) const {
 			const RectilinearGrid<Dimension> &original
 					= dynamic_cast<
 					const RectilinearGrid<Dimension> &>(
 					domain);
 
-			RectilinearGrid<Dimension> &refined = dynamic_cast<
+			std::unique_ptr< Domain<Dimension> > pointer(
+					new RectilinearGrid(original));
+
+			RectilinearGrid<Dimension> &refined =
+					static_cast<
 					RectilinearGrid<Dimension> &>(
 					*pointer);
 
-			// TODO: Optimize (loop unroll)
 			for(Index k = 0; k < Dimension; ++k) {
-				// Refine k-th axis
-
 				const Axis &n = original[k];
-				Axis &m = refined.axes[k];
-
-				m = Axis( n.size() * 2 - 1 );
-
-				m[0] = n[0];
-				Index i = 1, j = 1;
-				while(i < n.size()) {
-					m[j++] = ( n[i-1] + n[i] ) / 2.;
-					m[j++] = n[i++];
+				assert(flags[k].size() + 1 == (size_t) n.size());
+
+				std::vector<Real> ticks;
+				ticks.reserve(n.size() * 2 - 1);
+				ticks.push_back(n[0]);
+				for(Index i = 1; i < n.size(); ++i) {
+					if(flags[k][i - 1]) {
+						ticks.push_back(
+							(n[i-1] + n[i]) / 2.
+						);
+					}
+					ticks.push_back(n[i]);
 				}
+
+				refined.axes[k] = Axis(ticks);
 			}
 
 			refined.initialize();
@@ -1079,7 +1239,165 @@ public:
 		}
 
 	};
-	#endif
+
+	/**
+	 * Flags the intervals on which the error of linearly interpolating a
+	 * solution exceeds a tolerance. The error on an interval of length h is
+	 * estimated by \f$h^2\left|V''\right|/8\f$, where \f$V''\f$ is the
+	 * largest second divided difference of the solution (along the axis) at
+	 * either end of the interval, over all grid lines parallel to the axis.
+	 * Since the second divided difference across a kink is proportional to
+	 * the jump in the gradient, gradient discontinuities are flagged as
+	 * well.
+	 * @param solution A solution on this grid.
+	 * @param tolerance The tolerance.
+	 * @return The flagged intervals.
+	 */
+	IntervalFlags flagIntervals(const Vector &solution, Real tolerance)
+			const {
+		assert(solution.size() == vsize);
+
+		IntervalFlags flags;
+
+		for(Index k = 0; k < Dimension; ++k) {
+			const Axis &x = axes[k];
+			const Index n = x.size();
+			const Index stride = strides[k];
+
+			flags[k].assign(n - 1, false);
+
+			// Largest second divided difference at each tick
+			std::vector<Real> curvature(n, 0.);
+			for(auto row = rows(); *row < vsize; ++row) {
+				const Index node = *row;
+				const Index i = row[k];
+				if(i == 0 || i == n - 1) {
+					continue;
+				}
+
+				const Real hl = x[i] - x[i-1];
+				const Real hr = x[i+1] - x[i];
+				const Real d2 = 2. * (
+					(solution(node + stride)
+							- solution(node)) / hr
+					- (solution(node)
+							- solution(node - stride)) / hl
+				) / (hl + hr);
+
+				curvature[i] = std::max(curvature[i],
+						std::abs(d2));
+			}
+
+			for(Index i = 0; i < n - 1; ++i) {
+				const Real h = x[i+1] - x[i];
+				flags[k][i] = h * h / 8. * std::max(
+						curvature[i], curvature[i+1])
+						> tolerance;
+			}
+		}
+
+		return flags;
+	}
+
+	/**
+	 * Additionally flags the intervals across which a mask on the nodes
+	 * changes. Passing the mask returned by
+	 * QuantPDE::PenaltyMethod::constraintMask resolves the free boundary.
+	 * @param mask A mask on the nodes of this grid.
+	 * @param flags The flagged intervals.
+	 */
+	void flagIntervals(const std::vector<bool> &mask, IntervalFlags &flags)
+			const {
+		assert(mask.size() == (size_t) vsize);
+
+		for(Index k = 0; k < Dimension; ++k) {
+			const Index n = axes[k].size();
+			const Index stride = strides[k];
+
+			for(auto row = rows(); *row < vsize; ++row) {
+				const Index node = *row;
+				const Index i = row[k];
+				if(i < n - 1 && mask[node] != mask[node + stride]) {
+					flags[k][i] = true;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Solves on this grid, refines the intervals flagged by
+	 * QuantPDE::RectilinearGrid::flagIntervals, and re-solves until no
+	 * interval is flagged or the maximum number of refinements is reached.
+	 * The last solve is always performed on the returned grid, so that its
+	 * solution can be captured by the solver.
+	 *
+	 * \code{.cpp}
+	 * Vector v;
+	 * RectilinearGrid1 fine = coarse.adaptivelyRefined(
+	 * 	[&] (const RectilinearGrid1 &grid, std::vector<bool> &mask) {
+	 * 		// Solve on the grid...
+	 * 		v = ...;
+	 *
+	 * 		// ...optionally setting the mask, e.g.
+	 * 		// mask = penalty.constraintMask();
+	 *
+	 * 		return v;
+	 * 	},
+	 * 	1e-3 // Tolerance
+	 * );
+	 * \endcode
+	 *
+	 * Note that intervals across which the mask changes are flagged at
+	 * every refinement, so that the resolution of the free boundary is
+	 * limited only by the number of refinements.
+	 * @param solve Returns the solution on a grid and optionally sets a
+	 *              mask of nodes (left empty otherwise).
+	 * @param tolerance Tolerance for the interpolation error.
+	 * @param times Maximum number of refinements.
+	 * @return The refined grid.
+	 */
+	template <typename F>
+	RectilinearGrid adaptivelyRefined(F &&solve, Real tolerance,
+			int times = 8) const {
+		std::unique_ptr< Domain<Dimension> > pointer(
+				new RectilinearGrid(*this));
+		std::vector<bool> mask;
+
+		for(int t = 0; ; ++t) {
+			const RectilinearGrid &grid =
+					static_cast<const RectilinearGrid &>(
+					*pointer);
+
+			mask.clear();
+			const Vector solution = solve(grid, mask);
+
+			if(t == times) {
+				break;
+			}
+
+			IntervalFlags flags = grid.flagIntervals(solution,
+					tolerance);
+			if(!mask.empty()) {
+				grid.flagIntervals(mask, flags);
+			}
+
+			bool flagged = false;
+			for(Index k = 0; k < Dimension; ++k) {
+				for(bool flag : flags[k]) {
+					flagged = flagged || flag;
+				}
+			}
+			if(!flagged) {
+				break;
+			}
+
+			pointer = NewTickInFlaggedIntervals( std::move(flags) )
+					.refine(grid);
+		}
+
+		return RectilinearGrid( std::move(
+				static_cast<RectilinearGrid &>(*pointer)) );
+	}
 
 	/**
 	 * A refined grid constructed as follows: for each pair of adjacent tick
@@ -1132,6 +1450,7 @@ public:
 			// Create axis; size 2^t * |n| - 2^(t-1)
 			const int size = tmp * (n.size() - 1) + 1;
 			m = Axis(size);
+			m.uniformSpacing = n.uniformSpacing;
 
 			// Write nodes
 			m[0] = n[0];
@@ -1150,6 +1469,24 @@ public:
 		return refined;
 	}
 
+	/**
+	 * A grid refined a different number of times along each axis (as in
+	 * refined(int, unsigned int)), e.g. one of the anisotropic grids of
+	 * the sparse-grid combination technique.
+	 * @param levels The number of times to refine each axis.
+	 * @return A refined grid.
+	 * @see QuantPDE::combinationTechnique
+	 */
+	RectilinearGrid refined(const std::array<int, Dimension> &levels)
+			const {
+		Axis axes[Dimension];
+		for(Index k = 0; k < Dimension; ++k) {
+			// Refine the k-th axis only
+			axes[k] = refined(levels[k], ~(1u << k))[k];
+		}
+		return RectilinearGrid(axes);
+	}
+
 	// TODO: The axis constructor expects only const Axis& or Axis&& types;
 	//       fix this.
 
@@ -1195,22 +1532,15 @@ public:
 	/**
 	 * Copy constructor.
 	 */
-	RectilinearGrid(const RectilinearGrid &that) noexcept
-			: vsize(that.vsize) {
-		// TODO: Optimize (loop unroll)
-		for(Index i = 0; i < Dimension; ++i) {
-			axes[i] = that.axes[i];
-		};
+	RectilinearGrid(const RectilinearGrid &that) noexcept {
+		assign(that);
 	}
 
 	/**
 	 * Move constructor.
 	 */
-	RectilinearGrid(RectilinearGrid &&that) noexcept : vsize(that.vsize) {
-		// TODO: Optimize (loop unroll)
-		for(Index i = 0; i < Dimension; ++i) {
-			axes[i] = std::move(that.axes[i]);
-		};
+	RectilinearGrid(RectilinearGrid &&that) noexcept {
+		assign( std::move(that) );
 	}
 
 	// 2015-03-05: Decided to remove operator assignment and move
@@ -1411,20 +1741,118 @@ public:
 				"The number of arguments must be consistent "
 				"with the dimensions");
 
-		Index idxs[] {indices...};
+		const Index idxs[] {indices...};
+		return index(idxs);
+	}
 
-		Index
-			index = idxs[0],
-			horner = 1
-		;
+	/**
+	 * Transforms axes-indices to an index corresponding to the (natural)
+	 * order imposed by this grid.
+	 * @param indices The index of a tick on each axis.
+	 * @return The index.
+	 */
+	Index index(const Index (&indices)[Dimension]) const {
+		Index index = 0;
+		Unroll<Dimension>::apply([&] (Index i) {
+			index += strides[i] * indices[i];
+		});
+		return index;
+	}
 
-		// TODO: Optimize (loop unroll)
-		for(Index i = 0; i < Dimension - 1; ++i) {
-			horner *= axes[i].size();
-			index += horner * idxs[i + 1];
-		};
+	/**
+	 * @param d The index of an axis.
+	 * @return The difference between the indices of two nodes that are
+	 *         adjacent along the d-th axis (i.e. 1 for the first axis,
+	 *         the size of the first axis for the second, etc.).
+	 */
+	Index stride(Index d) const {
+		return strides[d];
+	}
 
-		return index;
+	/**
+	 * Walks the nodes of a grid in their natural order, keeping track of
+	 * the index of the tick on each axis. Advancing the iterator only
+	 * increments these indices (carrying over to the next axis when one
+	 * wraps around), which is cheaper than recovering them from each node
+	 * index by division (as indices() does).
+	 *
+	 * Example:
+	 * \code{.cpp}
+	 * for(auto row = grid.rows(); *row < grid.size(); ++row) {
+	 * 	// *row is the index of the node
+	 * 	// row[d] is the index of its tick on the d-th axis
+	 * }
+	 * \endcode
+	 */
+	class RowIterator final {
+
+		const RectilinearGrid *grid;
+		Index row;
+		Index ticks[Dimension];
+
+	public:
+
+		/**
+		 * Constructor.
+		 * @param grid The grid.
+		 * @param row The index of the first node to visit.
+		 */
+		RowIterator(const RectilinearGrid &grid, Index row) noexcept
+				: grid(&grid), row(row) {
+			const std::array<Index, Dimension> tmp = grid.indices(
+					row);
+			Unroll<Dimension>::apply([&] (Index i) {
+				ticks[i] = tmp[i];
+			});
+		}
+
+		/**
+		 * @return The index of the current node.
+		 */
+		Index operator*() const {
+			return row;
+		}
+
+		/**
+		 * @param d The index of an axis.
+		 * @return The index of the tick on the d-th axis of the
+		 *         current node.
+		 */
+		Index operator[](Index d) const {
+			return ticks[d];
+		}
+
+		/**
+		 * @return The index of the tick on each axis of the current
+		 *         node.
+		 */
+		const Index (&indices() const)[Dimension] {
+			return ticks;
+		}
+
+		/**
+		 * Advances to the next node.
+		 */
+		RowIterator &operator++() {
+			++row;
+			for(Index d = 0; d < Dimension; ++d) {
+				if(++ticks[d] < grid->axes[d].size()) {
+					break;
+				}
+				ticks[d] = 0;
+			}
+			return *this;
+		}
+
+	};
+
+	/**
+	 * @param first The index of the first node to visit.
+	 * @return An iterator over the nodes of this grid.
+	 * @see QuantPDE::RectilinearGrid::RowIterator
+	 */
+	RowIterator rows(Index first = 0) const {
+		return RowIterator(*this, first);
 	}
 
 	/**
@@ -1465,33 +1893,34 @@ public:
 	std::array<Index, Dimension> indices(Index index) const {
 		std::array<Index, Dimension> array;
 
-		Index m = 1;
-
-		// TODO: Optimize (loop unroll)
-		for(Index i = 0; i < Dimension - 1; ++i) {
-			m *= axes[i].size();
-		}
-
-		// TODO: Optimize (loop unroll)
-		for(Index i = Dimension - 1; i > 0; i--) {
-			array[i] = index / m;
-			index -= array[i] * m;
-			m /= axes[i].size();
-		}
+		Unroll<Dimension - 1>::apply([&] (Index j) {
+			const Index i = Dimension - 1 - j;
+			array[i] = index / strides[i];
+			index -= array[i] * strides[i];
+		});
 		array[0] = index;
 
 		return array;
 	}
 
+	virtual void blockCoordinates(Index begin, Index end,
+			Points<Dimension> &points) const {
+		for(auto row = rows(begin); *row < end; ++row) {
+			const Index k = *row - begin;
+			Unroll<Dimension>::apply([&] (Index d) {
+				points(k, d) = axes[d][row[d]];
+			});
+		}
+	}
+
 	virtual std::array<Real, Dimension> coordinates(Index index) const {
 		std::array<Real, Dimension> array;
 
-		std::array<Index, Dimension> tmp = indices(index);
+		const std::array<Index, Dimension> tmp = indices(index);
 
-		// TODO: Optimize (loop unroll)
-		for(Index i = 0; i < Dimension; ++i) {
+		Unroll<Dimension>::apply([&] (Index i) {
 			array[i] = axes[i][tmp[i]];
-		};
+		});
 
 		return array;
 	}
@@ -1,9 +1,12 @@
 #ifndef QUANT_PDE_CORE_EVENT_HPP
 #define QUANT_PDE_CORE_EVENT_HPP
 
-#include <functional> // std::function
-#include <memory>     // std::unique_ptr
+#include <algorithm>  // std::sort
+#include <functional> // std::function, std::greater, std::less
+#include <memory>     // std::shared_ptr, std::unique_ptr
+#include <tuple>      // std::tuple
 #include <utility>    // std::forward, std::move
+#include <vector>     // std::vector
 
 namespace QuantPDE {
 
@@ -25,6 +28,28 @@ typedef Transform<1> Transform1;
 typedef Transform<2> Transform2;
 typedef Transform<3> Transform3;
 
+/**
+ * A transform that only reads the solution at the node it is applied to. Its
+ * first argument is the value of the solution at the node and the remaining
+ * arguments are the coordinates of the node.
+ */
+template <unsigned N>
+using PointwiseTransform = Function<N + 1>;
+
+typedef PointwiseTransform<1> PointwiseTransform1;
+typedef PointwiseTransform<2> PointwiseTransform2;
+typedef PointwiseTransform<3> PointwiseTransform3;
+
+/**
+ * A predicate on the coordinates of a node.
+ */
+template <unsigned N>
+using NodeSelector = std::function< NaryFunctionSignature<bool, N, Real> >;
+
+typedef NodeSelector<1> NodeSelector1;
+typedef NodeSelector<2> NodeSelector2;
+typedef NodeSelector<3> NodeSelector3;
+
 /**
  * Transforms a vector.
  */
@@ -187,6 +212,209 @@ typedef Event<1> Event1;
 typedef Event<2> Event2;
 typedef Event<3> Event3;
 
+/**
+ * An event whose transform only depends on the value of the solution at each
+ * node (e.g. the Bermudan put \f$\max\left(V, K - S\right)\f$ or a coupon
+ * payment \f$V + c\f$). No interpolant is built: the transform is applied in
+ * a single pass over the grid, in place whenever possible.
+ *
+ * The Bermudan put event from QuantPDE::Event becomes
+ * \code{.cpp}
+ * [K] (Real V, Real S) {
+ * 	return max( V, K - S );
+ * }
+ * \endcode
+ */
+template <Index Dimension>
+class PointwiseEvent : public EventBase {
+
+	PointwiseTransform<Dimension> transform;
+	const RectilinearGrid<Dimension> *grid;
+
+	void apply(Vector &vector) const {
+		assert(vector.size() == grid->size());
+
+		const Axis &x = (*grid)[0];
+		const Real *ticks = x.ticks();
+		const Index n = x.size();
+
+		// The first argument is the value; the rest are coordinates
+		Real args[Dimension + 1];
+		Index idxs[Dimension];
+		for(Index d = 0; d < Dimension; ++d) {
+			idxs[d] = 0;
+			args[d + 1] = (*grid)[d][0];
+		}
+
+		// Walk the grid in its natural order; the first axis varies
+		// fastest, so each line along it is contiguous in memory
+		Real *v = vector.data();
+		for(Index k = 0; k < grid->size(); k += n) {
+			for(Index i = 0; i < n; ++i) {
+				args[0] = v[k + i];
+				args[1] = ticks[i];
+				v[k + i] = packAndCall<Dimension + 1>(
+						transform, args);
+			}
+
+			for(Index d = 1; d < Dimension; ++d) {
+				if(++idxs[d] < (*grid)[d].size()) {
+					args[d + 1] = (*grid)[d][idxs[d]];
+					break;
+				}
+				idxs[d] = 0;
+				args[d + 1] = (*grid)[d][0];
+			}
+		}
+	}
+
+	virtual Vector doEvent(const Vector &vector) const {
+		Vector v = vector;
+		apply(v);
+		return v;
+	}
+
+	virtual Vector doEvent(Vector &&vector) const {
+		apply(vector);
+		return std::move(vector);
+	}
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param transform A function of the value of the solution at a node
+	 *                  and the coordinates of that node.
+	 * @param grid A rectilinear grid.
+	 */
+	template <typename T>
+	PointwiseEvent(
+		T &&transform,
+		const RectilinearGrid<Dimension> &grid
+	) noexcept :
+		transform(std::forward<T>(transform)),
+		grid(&grid)
+	{
+	}
+
+};
+
+typedef PointwiseEvent<1> PointwiseEvent1;
+typedef PointwiseEvent<2> PointwiseEvent2;
+typedef PointwiseEvent<3> PointwiseEvent3;
+
+/**
+ * A pointwise event that only touches a fixed subset of the nodes (e.g. a
+ * knock-out region or a payment conditional on the state). The subset and the
+ * coordinates of its nodes are computed once, on construction, so that the
+ * cost of each application is proportional to the number of affected nodes.
+ * @see QuantPDE::PointwiseEvent
+ */
+template <Index Dimension>
+class SparsePointwiseEvent : public EventBase {
+
+	PointwiseTransform<Dimension> transform;
+	std::vector<Index> rows;
+	std::vector<Real> coordinates;
+
+	void apply(Vector &vector) const {
+		Real args[Dimension + 1];
+		const Real *x = coordinates.data();
+		for(Index row : rows) {
+			assert(row < vector.size());
+
+			args[0] = vector(row);
+			for(Index d = 0; d < Dimension; ++d) {
+				args[d + 1] = *(x++);
+			}
+			vector(row) = packAndCall<Dimension + 1>(transform,
+					args);
+		}
+	}
+
+	void initialize(const Domain<Dimension> &domain) {
+		coordinates.reserve(rows.size() * Dimension);
+		for(Index row : rows) {
+			assert(row >= 0 && row < domain.size());
+
+			const auto x = domain.coordinates(row);
+			coordinates.insert(coordinates.end(), x.begin(),
+					x.end());
+		}
+	}
+
+	virtual Vector doEvent(const Vector &vector) const {
+		Vector v = vector;
+		apply(v);
+		return v;
+	}
+
+	virtual Vector doEvent(Vector &&vector) const {
+		apply(vector);
+		return std::move(vector);
+	}
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param transform A function of the value of the solution at a node
+	 *                  and the coordinates of that node.
+	 * @param domain The domain.
+	 * @param rows The indices of the nodes to transform; all other nodes
+	 *             are left untouched.
+	 */
+	template <typename T>
+	SparsePointwiseEvent(
+		T &&transform,
+		const Domain<Dimension> &domain,
+		std::vector<Index> rows
+	) :
+		transform(std::forward<T>(transform)),
+		rows(std::move(rows))
+	{
+		initialize(domain);
+	}
+
+	/**
+	 * Constructor.
+	 * @param transform A function of the value of the solution at a node
+	 *                  and the coordinates of that node.
+	 * @param domain The domain.
+	 * @param selector Returns true if and only if the node at the given
+	 *                 coordinates should be transformed.
+	 */
+	template <typename T>
+	SparsePointwiseEvent(
+		T &&transform,
+		const Domain<Dimension> &domain,
+		const NodeSelector<Dimension> &selector
+	) :
+		transform(std::forward<T>(transform))
+	{
+		for(Index i = 0; i < domain.size(); ++i) {
+			const auto x = domain.coordinates(i);
+			if(packAndCall<Dimension>(selector, x.data())) {
+				rows.push_back(i);
+			}
+		}
+
+		initialize(domain);
+	}
+
+	/**
+	 * @return The indices of the nodes touched by this event.
+	 */
+	const std::vector<Index> &affectedRows() const {
+		return rows;
+	}
+
+};
+
+typedef SparsePointwiseEvent<1> SparsePointwiseEvent1;
+typedef SparsePointwiseEvent<2> SparsePointwiseEvent2;
+typedef SparsePointwiseEvent<3> SparsePointwiseEvent3;
+
 /**
  * The null event returns the original vector (no transformation occurs).
  */
@@ -197,7 +425,7 @@ class NullEvent : public EventBase {
 	}
 
 	virtual Vector doEvent(Vector &&vector) const {
-		return vector;
+		return std::move(vector);
 	}
 
 };
@@ -217,11 +445,155 @@ class DoEvent : public EventBase {
 
 	virtual Vector doEvent(Vector &&vector) const {
 		onCall(vector);
+		return std::move(vector);
+	}
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * An immutable list of events sorted in the order in which they are handled.
+ * Events occurring at the same time are grouped together; the last group is
+ * always at the terminal time (it may be empty).
+ *
+ * A schedule is built once (e.g. by a TimeIteration on its first solve) and
+ * reused by every subsequent solve. The schedule itself (the order and
+ * grouping of its entries) is never modified, and so can be shared by
+ * iterative methods running on different threads. The events it holds are
+ * shared as well, and so must themselves be safe to handle concurrently if
+ * this is done (some events, such as those of QuantPDE::Modules::HJBQVI, write
+ * state when handled).
+ *
+ * @tparam Forward True if and only if time moves forward in the relevant
+ *                 initial value problem.
+ * @see QuantPDE::TimeIteration
+ */
+template <bool Forward>
+class EventSchedule final {
+
+public:
+
+	/**
+	 * An event along with its time and the order in which it was added.
+	 */
+	typedef std::tuple<
+		unsigned,
+		Real,
+		std::shared_ptr<EventBase>
+	> Entry;
+
+private:
+
+	typedef typename std::conditional<
+		Forward,
+		std::greater<Real>,
+		std::less<Real>
+	>::type Order;
+
+	std::vector<Entry> entries;
+	std::vector<Real> times;
+	std::vector<size_t> offsets;
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param entries The events.
+	 * @param terminalTime The time at which iteration terminates.
+	 */
+	EventSchedule(std::vector<Entry> entries, Real terminalTime)
+			: entries(std::move(entries)) {
+		// If events are set to the same time, ties are broken depending
+		// on the order they were added. Events added later are assumed
+		// to occur later in time (e.g. handled earlier if
+		// Forward == true; later otherwise).
+		std::sort(
+			this->entries.begin(),
+			this->entries.end(),
+			[] (const Entry &a, const Entry &b) {
+				return
+					Order()( std::get<1>(b),
+							std::get<1>(a) )
+					|| (
+						std::get<1>(a)
+						== std::get<1>(b)
+						&& Order()( std::get<0>(b),
+							std::get<0>(a) )
+					)
+				;
+			}
+		);
+
+		for(size_t k = 0; k < this->entries.size(); ++k) {
+			const Real time = std::get<1>(this->entries[k]);
+			assert(!Order()(time, terminalTime));
+
+			if(times.empty() || times.back() != time) {
+				times.push_back(time);
+				offsets.push_back(k);
+			}
+		}
+
+		if(times.empty() || times.back() != terminalTime) {
+			times.push_back(terminalTime);
+			offsets.push_back(this->entries.size());
+		}
+
+		offsets.push_back(this->entries.size());
+	}
+
+	// Disable copy constructor and assignment operator.
+	EventSchedule(const EventSchedule &) = delete;
+	EventSchedule &operator=(const EventSchedule &) = delete;
+
+	/**
+	 * @return The number of distinct event times.
+	 */
+	size_t size() const {
+		return times.size();
+	}
+
+	/**
+	 * @param group The index of a group of events.
+	 * @return The time at which the group of events occurs.
+	 */
+	Real time(size_t group) const {
+		return times[group];
+	}
+
+	/**
+	 * @return The event times, in the order in which they are handled.
+	 */
+	const std::vector<Real> &eventTimes() const {
+		return times;
+	}
+
+	/**
+	 * @return The events, in the order in which they are handled.
+	 */
+	const std::vector<Entry> &events() const {
+		return entries;
+	}
+
+	/**
+	 * Applies a group of events to a vector.
+	 * @param group The index of a group of events.
+	 * @param vector The vector.
+	 * @return The transformed vector.
+	 */
+	Vector apply(size_t group, Vector vector) const {
+		for(size_t k = offsets[group]; k < offsets[group + 1]; ++k) {
+			vector = (*std::get<2>(entries[k]))(std::move(vector));
+		}
 		return vector;
 	}
 
 };
 
+typedef EventSchedule<false> ReverseEventSchedule;
+typedef EventSchedule<true > ForwardEventSchedule;
+
 }
 
 #endif
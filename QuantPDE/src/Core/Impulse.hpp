@@ -1,10 +1,13 @@
 #ifndef QUANT_PDE_CORE_IMPULSE
 #define QUANT_PDE_CORE_IMPULSE
 
-#include <array>   // std::array
-#include <cstdint> // std::intmax_t
-#include <tuple>   // std::get
-#include <utility> // std::forward
+#include <algorithm> // std::sort
+#include <array>     // std::array
+#include <cassert>   // assert
+#include <cstdint>   // std::intmax_t
+#include <tuple>     // std::get
+#include <utility>   // std::forward
+#include <vector>    // std::vector
 
 namespace QuantPDE {
 
@@ -33,10 +36,13 @@ namespace QuantPDE {
  */
 template <Index Dimension, Index ControlDimension, bool Negative = false>
 class Impulse final : public RawControlledLinearSystem<Dimension,
+		ControlDimension>, public RowwiseControlledLinearSystem<
 		ControlDimension> {
 
 	typedef IntegerPower<2, Dimension> TwoToTheDimension;
 
+	typedef RowwiseControlledLinearSystem<ControlDimension> Rowwise;
+
 	const RectilinearGrid<Dimension> &grid;
 
 	// t, x1, ..., xn, q1, ..., qn
@@ -45,6 +51,193 @@ class Impulse final : public RawControlledLinearSystem<Dimension,
 	F flow;
 	std::array<F, Dimension> transitions;
 
+	// A row of A and b memoized for a particular control
+	struct CachedRow {
+		typename Rowwise::Control control;
+		typename Rowwise::Entry entries[TwoToTheDimension::value + 1];
+		int count;
+		Real b;
+	};
+
+	// Memoized rows of each node and the slot to overwrite next once a
+	// node's rows are full
+	std::vector<std::vector<CachedRow>> cache;
+	std::vector<unsigned> cache_next;
+	unsigned cache_capacity;
+
+	void computeStrides(Index (&strides)[Dimension]) const {
+		strides[0] = 1;
+		for(Index i = 1; i < Dimension; ++i) {
+			strides[i] = strides[i - 1] * grid[i - 1].size();
+		}
+	}
+
+	/**
+	 * Computes row k of A(t) and b(t).
+	 * @param k The row.
+	 * @param args The time, the coordinates of the k-th node, and the
+	 *             control.
+	 * @param strides The distance between adjacent nodes along each axis.
+	 * @param entries On output, the nonzero entries of the row.
+	 * @param count On output, the number of entries.
+	 * @return The entry of b(t) at this row.
+	 */
+	Real assembleRow(Index k, const Real *args, const Index *strides,
+			typename Rowwise::Entry *entries, int &count) const {
+		typedef typename Rowwise::Entry Entry;
+
+		// Local copies, so that writing the entries does not force the
+		// compiler to reload these
+		Real local[Dimension + ControlDimension + 1];
+		Index stride[Dimension];
+		for(int i = 0; i < Dimension + ControlDimension + 1; ++i) {
+			local[i] = args[i];
+		}
+		for(int i = 0; i < Dimension; ++i) {
+			stride[i] = strides[i];
+		}
+
+		// Get new state
+		Real plus[Dimension];
+		for(int i = 0; i < Dimension; ++i) {
+			plus[i] = packAndCall<
+				  Dimension
+				+ ControlDimension
+				+ 1
+			>(transitions[i], local);
+		}
+
+		auto data = linearInterpolationData(grid, plus);
+
+		// Row k of the identity minus the interpolation weights (or
+		// vice versa), as in A(t)
+		int n = 0;
+		bool diagonal = false;
+		for(std::intmax_t i = 0; i < TwoToTheDimension::value; ++i) {
+			Real factor = 1.;
+			Index j = 0;
+
+			for(Index l = 0; l < Dimension; ++l) {
+				if(i & (1 << l)) {
+					j += std::get<0>(data[l]) * stride[l];
+					factor *= std::get<1>(data[l]);
+				} else {
+					j += (std::get<0>(data[l]) + 1)
+							* stride[l];
+					factor *= -std::get<1>(data[l]) + 1.;
+				}
+			}
+
+			Real value;
+			if(j == k) {
+				diagonal = true;
+				value = Negative ? factor - 1. : 1. - factor;
+			} else {
+				value = Negative ? factor : 0. - factor;
+			}
+			entries[n++] = Entry(j, value);
+		}
+
+		if(!diagonal) {
+			entries[n++] = Entry(k, Negative ? -1. : 1.);
+		}
+
+		count = n;
+		return (Negative ? -1. : 1.) * packAndCall<Dimension
+				+ ControlDimension + 1>(flow, local);
+	}
+
+	/**
+	 * Looks up row k of A and b for a control, computing and memoizing it
+	 * on a miss. The entries of a memoized row are sorted by column.
+	 * Distinct rows can be looked up concurrently.
+	 */
+	const CachedRow &cachedRow(Real t,
+			const typename Rowwise::Control &control, Index k,
+			const Index *strides) {
+		typedef typename Rowwise::Entry Entry;
+
+		std::vector<CachedRow> &rows = cache[k];
+		for(const CachedRow &row : rows) {
+			if(row.control == control) {
+				return row;
+			}
+		}
+
+		CachedRow *row;
+		if(rows.size() < cache_capacity) {
+			rows.emplace_back();
+			row = &rows.back();
+		} else {
+			row = &rows[cache_next[k]];
+			cache_next[k] = (cache_next[k] + 1) % cache_capacity;
+		}
+
+		Real args[Dimension + ControlDimension + 1];
+		args[0] = t;
+		const std::array<Real, Dimension> node = grid.coordinates(k);
+		for(int i = 0; i < Dimension; ++i) {
+			args[i + 1] = node[i];
+		}
+		for(int i = 0; i < ControlDimension; ++i) {
+			args[Dimension + i + 1] = control[i];
+		}
+
+		row->control = control;
+		row->b = assembleRow(k, args, strides, row->entries,
+				row->count);
+		std::sort(row->entries, row->entries + row->count,
+				[] (const Entry &a, const Entry &b) {
+					return a.first < b.first;
+				});
+
+		return *row;
+	}
+
+	/**
+	 * Assembles A(t) and b(t) from the memoized rows.
+	 */
+	void gather(Real t, Matrix *A, Vector *b) {
+		assert(cache.size() == (size_t) grid.size());
+
+		Index strides[Dimension];
+		computeStrides(strides);
+
+		const Index n = grid.size();
+		if(A) {
+			*A = Matrix(n, n);
+			A->reserve(n * (TwoToTheDimension::value + 1));
+		}
+		if(b) {
+			*b = grid.vector();
+		}
+
+		typename Rowwise::Control control;
+		for(Index k = 0; k < n; ++k) {
+			for(int i = 0; i < ControlDimension; ++i) {
+				control[i] = (this->control(i))(k);
+			}
+
+			const CachedRow &row = cachedRow(t, control, k,
+					strides);
+
+			if(A) {
+				A->startVec(k);
+				for(int l = 0; l < row.count; ++l) {
+					A->insertBack(k, row.entries[l].first)
+							= row.entries[l].second;
+				}
+			}
+			if(b) {
+				(*b)(k) = row.b;
+			}
+		}
+
+		if(A) {
+			A->finalize();
+		}
+	}
+
 public:
 
 	/**
@@ -62,7 +255,8 @@ public:
 	) noexcept :
 		grid(grid),
 		flow( std::forward<F1>(flow) ),
-		transitions( {{std::forward<F2>(transitions)...}} )
+		transitions( {{std::forward<F2>(transitions)...}} ),
+		cache_capacity(0)
 	{
 	}
 
@@ -78,13 +272,40 @@ public:
 	) noexcept :
 		grid(grid),
 		flow( std::forward<F1>(flow) ),
-		transitions( transitions )
+		transitions( transitions ),
+		cache_capacity(0)
 	{
 	}
 
+	/**
+	 * Memoizes, for each node, the rows of A and b for the last few
+	 * controls they were assembled with. Interpolating the transitions is
+	 * then only done the first time a node sees a control, and assembling
+	 * A for a control vector that was seen before is a gather.
+	 *
+	 * Rows are memoized regardless of time, so this is only valid if the
+	 * flow and transition functions do not depend on time. The grid
+	 * should not change after calling this.
+	 *
+	 * @param capacity The number of controls memoized per node.
+	 */
+	void cacheRows(unsigned capacity = 4) {
+		assert(capacity > 0);
+
+		cache_capacity = capacity;
+		cache.assign(grid.size(), std::vector<CachedRow>());
+		cache_next.assign(grid.size(), 0);
+	}
+
 	// TODO: Allow for multiple types of interpolation
 
 	virtual Matrix A(Real t) {
+		if(cache_capacity) {
+			Matrix A;
+			gather(t, &A, nullptr);
+			return A;
+		}
+
 		Matrix M = grid.matrix();
 		M.reserve(IntegerVector::Constant(
 			grid.size(),
@@ -184,6 +405,12 @@ public:
 	}
 
 	virtual Vector b(Real t) {
+		if(cache_capacity) {
+			Vector b;
+			gather(t, nullptr, &b);
+			return b;
+		}
+
 		Vector b(grid.vector());
 
 		// flow function at time t
@@ -215,6 +442,81 @@ public:
 		return b;
 	}
 
+	virtual Real row(Real t, const typename Rowwise::Control &control,
+			Index k, std::vector<typename Rowwise::Entry> &entries) {
+		typedef typename Rowwise::Entry Entry;
+
+		Index strides[Dimension];
+		computeStrides(strides);
+
+		if(cache_capacity) {
+			assert(cache.size() == (size_t) grid.size());
+
+			const CachedRow &cached = cachedRow(t, control, k,
+					strides);
+			entries.insert(entries.end(), cached.entries,
+					cached.entries + cached.count);
+			return cached.b;
+		}
+
+		Real args[Dimension + ControlDimension + 1];
+		args[0] = t;
+
+		// Coordinates
+		const std::array<Real, Dimension> node = grid.coordinates(k);
+		for(int i = 0; i < Dimension; ++i) {
+			args[i + 1] = node[i];
+		}
+
+		// Control coordinates
+		for(int i = 0; i < ControlDimension; ++i) {
+			args[Dimension + i + 1] = control[i];
+		}
+
+		Entry buffer[TwoToTheDimension::value + 1];
+		int count;
+		const Real b = assembleRow(k, args, strides, buffer, count);
+		entries.insert(entries.end(), buffer, buffer + count);
+		return b;
+	}
+
+	virtual void residuals(Real t, const Vector &x,
+			const std::vector<typename Rowwise::Control> &controls,
+			Index begin, Index end, Real *residuals) {
+		typedef typename Rowwise::Entry Entry;
+
+		Index strides[Dimension];
+		computeStrides(strides);
+
+		Real args[Dimension + ControlDimension + 1];
+		Entry entries[TwoToTheDimension::value + 1];
+
+		args[0] = t;
+
+		for(Index k = begin; k < end; ++k) {
+			// Coordinates
+			const std::array<Real, Dimension> node =
+					grid.coordinates(k);
+			for(int i = 0; i < Dimension; ++i) {
+				args[i + 1] = node[i];
+			}
+
+			for(const auto &control : controls) {
+				// Control coordinates
+				for(int i = 0; i < ControlDimension; ++i) {
+					args[Dimension + i + 1] = control[i];
+				}
+
+				int count;
+				const Real flow_k = assembleRow(k, args,
+						strides, entries, count);
+
+				*(residuals++) = Rowwise::rowProduct(entries,
+						count, x) - flow_k;
+			}
+		}
+	}
+
 };
 
 template <Index ControlDimension>
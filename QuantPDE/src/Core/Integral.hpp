@@ -4,19 +4,41 @@
 #include <array>       // std::array
 #include <cstdint>     // std::intmax_t
 #include <cstdlib>     // std::abs
+#include <functional>  // std::function
 #include <limits>      // std::numeric_limits
-#include <type_traits> // std::enable_if
+#include <type_traits> // std::enable_if, std::false_type, std::is_constructible,
+                       // std::integral_constant, std::true_type
 #include <utility>     // std::forward, std::move
 
 // TODO: static integrate method
 
 namespace QuantPDE {
 
+/**
+ * A batch of abscissae in \f$\mathbb{R}^{n}\f$, one per row.
+ * @tparam Dimension \f$n\f$.
+ */
+template <Index Dimension>
+using Abscissae = Eigen::Array<Real, Eigen::Dynamic, Dimension>;
+
+/**
+ * An integrand evaluated on a batch of abscissae at once. The result holds the
+ * value of the integrand at each row of the argument. Since each column of the
+ * argument holds one coordinate, such integrands can be written as
+ * (vectorized) Eigen array expressions.
+ * @tparam Dimension \f$n\f$.
+ */
+template <Index Dimension>
+using BatchFunction = std::function<Vector (const Abscissae<Dimension> &)>;
+
 /**
  * A function defined by
  * \f$F\left(\mathbf{x}\right)\equiv\int_{\mathbf{a}}^{\mathbf{x}}f\left(\mathbf{y}\right)d\mathbf{y}\f$,
  * where \f$f\colon\mathbb{R}^{n}\rightarrow\mathbb{R}\f$ and \f$\mathbb{a}\f$
  * are fixed.
+ *
+ * The integrand \f$f\f$ is either a function of \f$n\f$ arguments or a
+ * QuantPDE::BatchFunction.
  * @tparam Dimension \f$n\f$.
  */
 template <Index Dimension>
@@ -33,6 +55,9 @@ class Integral {
 
 	Real tolerance;
 
+	template <typename F>
+	using IsBatch = std::is_constructible<BatchFunction<Dimension>, F>;
+
 protected:
 
 	// TODO: Use templates to select first Dimension arguments in tolerance
@@ -40,6 +65,28 @@ protected:
 	std::array<Real, Dimension> a;
 
 	const Function<Dimension> function;
+	const BatchFunction<Dimension> batch;
+
+	/**
+	 * Evaluates the integrand at each of the abscissae.
+	 * @param x The abscissae.
+	 * @return The values of the integrand.
+	 */
+	Vector evaluate(const Abscissae<Dimension> &x) const {
+		if(batch) {
+			return batch(x);
+		}
+
+		Vector values(x.rows());
+		Real point[Dimension];
+		for(Index i = 0; i < x.rows(); ++i) {
+			for(Index j = 0; j < Dimension; ++j) {
+				point[j] = x(i, j);
+			}
+			values(i) = packAndCall<Dimension>(function, point);
+		}
+		return values;
+	}
 
 public:
 
@@ -49,7 +96,7 @@ public:
 	 * @param a Lower bounds of integration.
 	 */
 	template <typename F, typename ...Ts, typename std::enable_if<Dimension
-			== sizeof...(Ts), int>::type = 0>
+			== sizeof...(Ts) && !IsBatch<F>::value, int>::type = 0>
 	Integral(F &&function, Ts ...a) noexcept
 			: tolerance(QuantPDE::tolerance),
 			a( {{a...}} ), function(std::forward<F>(function)) {
@@ -62,7 +109,8 @@ public:
 	            corresponds to the tolerance.
 	 */
 	template <typename F, typename ...Ts, typename std::enable_if<Dimension
-			+ 1 == sizeof...(Ts), int>::type = 0>
+			+ 1 == sizeof...(Ts) && !IsBatch<F>::value, int>::type
+			= 0>
 	Integral(F &&function, Ts ...a) noexcept
 			: function(std::forward<F>(function)) {
 		tolerance = Select<Dimension, Ts...>::get(a...);
@@ -73,19 +121,50 @@ public:
 		}
 	}
 
+	/**
+	 * Constructor for a batch integrand.
+	 * @param batch Function to integrate.
+	 * @param a Lower bounds of integration.
+	 */
+	template <typename F, typename ...Ts, typename std::enable_if<Dimension
+			== sizeof...(Ts) && IsBatch<F>::value, int>::type = 0>
+	Integral(F &&batch, Ts ...a) noexcept
+			: tolerance(QuantPDE::tolerance),
+			a( {{a...}} ), batch(std::forward<F>(batch)) {
+	}
+
+	/**
+	 * Constructor for a batch integrand with specified tolerance.
+	 * @param batch Function to integrate.
+	 * @param a Lower bounds of integration. The last argument in the pack
+	            corresponds to the tolerance.
+	 */
+	template <typename F, typename ...Ts, typename std::enable_if<Dimension
+			+ 1 == sizeof...(Ts) && IsBatch<F>::value, int>::type
+			= 0>
+	Integral(F &&batch, Ts ...a) noexcept
+			: batch(std::forward<F>(batch)) {
+		tolerance = Select<Dimension, Ts...>::get(a...);
+
+		Real tmp[] {a...};
+		for(Index i = 0; i < Dimension; ++i) {
+			this->a[i] = tmp[i];
+		}
+	}
+
 	/**
 	 * Copy constructor.
 	 */
 	Integral(const Integral &that) noexcept : tolerance(that.tolerance),
-			a(that.a), function(that.function) {
+			a(that.a), function(that.function), batch(that.batch) {
 	}
 
 	/**
 	 * Move constructor.
 	 */
 	Integral(Integral &&that) noexcept : tolerance(that.tolerance),
-			a(std::move(that.a)), function(std::move(that.function))
-			{
+			a(std::move(that.a)), function(std::move(that.function)),
+			batch(std::move(that.batch)) {
 	}
 
 	/**
@@ -95,6 +174,7 @@ public:
 		tolerance = that.tolerance;
 		a = that.a;
 		function = that.function;
+		batch = that.batch;
 		return *this;
 	}
 
@@ -105,6 +185,7 @@ public:
 		tolerance = that.tolerance;
 		a = std::move(that.a);
 		function = std::move(that.function);
+		batch = std::move(that.batch);
 		return *this;
 	}
 
@@ -174,38 +255,57 @@ public:
 			return compute(aa, xx);
 		}
 
-		// TODO: Currently, we are reintegrating over the whole region
-		//       of integration at every iteration. This is redundant!
-		//       Can save roughly 1/2^N of the time if we reuse the
-		//       integral over the subregion. This is particularly
-		//       noticeable when N = 1 (one dimension).
-
 		// Keep expanding the region of integration until convergence is
-		// attained
-		Real previous = compute(aa, xx);
-		Real integral;
+		// attained, integrating only over the slabs that are added to
+		// the region at each expansion
+		Real integral = compute(aa, xx);
 		while(true) {
 			// Expand the region of integration
+			std::array<Real, Dimension> na(aa), nx(xx);
+			for(Index i = 0; i < Dimension; ++i) {
+				if(neginf[i]) {
+					na[i] += aa[i] - m[i];
+				}
+
+				if(posinf[i]) {
+					nx[i] += xx[i] - m[i];
+				}
+			}
+
+			// The added region is the disjoint union of slabs in
+			// which the i-th coordinate lies outside of the old
+			// region, the preceding coordinates lie inside of the
+			// old region, and the subsequent coordinates lie inside
+			// of the new region
+			Real added = 0.;
 			for(Index i = 0; i < Dimension; ++i) {
+				std::array<Real, Dimension> sa(aa), sx(xx);
+				for(Index j = i + 1; j < Dimension; ++j) {
+					sa[j] = na[j];
+					sx[j] = nx[j];
+				}
+
 				if(neginf[i]) {
-					aa[i] += aa[i] - m[i];
+					sa[i] = na[i];
+					sx[i] = aa[i];
+					added += compute(sa, sx);
 				}
 
 				if(posinf[i]) {
-					xx[i] += xx[i] - m[i];
+					sa[i] = xx[i];
+					sx[i] = nx[i];
+					added += compute(sa, sx);
 				}
 			}
 
-			// Recompute the integral
-			integral = compute(aa, xx);
+			integral += added;
+			aa = na;
+			xx = nx;
 
 			// Break when the relative error is low enough
-			if(std::abs( (integral - previous) / integral )
-					< tolerance) {
+			if(std::abs( added / integral ) < tolerance) {
 				break;
 			}
-
-			previous = integral;
 		}
 
 		return integral;
@@ -215,59 +315,14 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 
-/**
- * Computes the sum appearing in the uniform trapezoidal rule efficiently for
- * arbitrary dimensionality.
- * @tparam N Dimension.
- * @tparam Is The number of intervals to use per dimension.
- * @see QuantPDE::TrapezoidalRule
- */
-template <Index N, int ...Is>
-struct TrapezoidalRuleSubroutine {
-};
-
-template <Index N, int I, int ...Is>
-struct TrapezoidalRuleSubroutine<N, I, Is...> {
-	static_assert(I > 0, "The number of intervals must be positive");
-
-	template <typename F>
-	static inline Real compute(const F &function, const Real *a,
-			const Real *x) {
-		Real sum;
-
-		// Left endpoint
-		sum = function(*a) * TrapezoidalRuleSubroutine<N-1, Is...>
-				::compute(function, a+1, x+1);
-
-		// Interior points
-		const Real dx = (*x - *a) / I;
-		for(int i = 1; i <= I - 1; ++i) {
-			sum += 2 * function(*a + i * dx)
-					* TrapezoidalRuleSubroutine<N-1, Is...>
-					::compute(function, a+1, x+1);
-		}
-
-		// Right endpoint
-		sum += function(*x) * TrapezoidalRuleSubroutine<N-1, Is...>
-				::compute(function, a+1, x+1);
-
-		return sum;
-	}
-};
-
-template <>
-struct TrapezoidalRuleSubroutine<0> {
-	template <typename F>
-	static inline Real compute(const F &, const Real *, const Real *) {
-		return 1.;
-	}
-};
-
 /**
  * Performs the trapezoidal rule assuming a uniform grid.
  * In one dimension, the trapezoidal rule (on the uniform grid
  * \f$a\equiv x_{1}<x_{2}<\ldots<x_{N+1}\equiv x\f$) is
  * \f$\int_{a}^{x}f\left(y\right)dy\approx\frac{x-a}{2N}\left(f\left(x_{1}\right)+2f\left(x_{2}\right)+\ldots+2f\left(x_{N}\right)+f\left(x_{N+1}\right)\right)\f$.
+ * In several dimensions, the integrand is evaluated on all nodes of the
+ * tensor-product grid at once (see QuantPDE::BatchFunction) and contracted
+ * against the tensor product of the one-dimensional weights.
  * @tparam Dimension \f$n\f$.
  * @tparam Intervals The number of intervals to use per dimension.
  * @see QuantPDE::Integral
@@ -279,21 +334,85 @@ class TrapezoidalRule : public Integral<Dimension> {
 			"The number of arguments must be consistent with the "
 			"dimensions");
 
+	// Number of nodes, (N_1 + 1) * (N_2 + 1) * ... * (N_n + 1)
+	typedef IntegerProduct<(Intervals + 1)...> Nodes;
+
+	/**
+	 * @return The (unscaled) weight of each node of the tensor-product
+	 *         rule, with the first coordinate varying fastest.
+	 */
+	static Vector weights() {
+		const int intervals[] = {Intervals...};
+
+		Vector weights = Vector::Ones(Nodes::value);
+		std::intmax_t stride = 1;
+		for(Index j = 0; j < Dimension; ++j) {
+			for(std::intmax_t k = 0; k < Nodes::value; ++k) {
+				const int i = (k / stride) % (intervals[j] + 1);
+				if(i > 0 && i < intervals[j]) {
+					weights(k) *= 2.;
+				}
+			}
+			stride *= intervals[j] + 1;
+		}
+
+		return weights;
+	}
+
 	virtual Real compute(const std::array<Real, Dimension> &a,
 			const std::array<Real, Dimension> &x) const {
 		// 2^n
 		typedef IntegerPower<2, Dimension> Power;
 
-		// Product of N_1 * N_2 * ... * N_n
-		typedef IntegerProduct<Intervals...> Product;
+		// The weights only depend on the number of intervals
+		static const Vector w = weights();
+
+		const int intervals[] = {Intervals...};
 
 		double scale = 1. / Power::value;
+		Real dx[Dimension];
 		for(int i = 0; i < Dimension; ++i) {
-			scale *= (x[i] - a[i]) / Product::value;
+			dx[i] = (x[i] - a[i]) / intervals[i];
+			scale *= dx[i];
 		}
 
-		return scale*TrapezoidalRuleSubroutine<Dimension, Intervals...>
-				::compute(this->function, a.data(), x.data());
+		// Visits the nodes of the tensor-product rule in order, with the
+		// first coordinate varying fastest
+		int index[Dimension];
+		Real point[Dimension];
+		for(Index j = 0; j < Dimension; ++j) {
+			index[j] = 0;
+			point[j] = a[j];
+		}
+		auto next = [&] () {
+			for(Index j = 0; j < Dimension; ++j) {
+				if(++index[j] <= intervals[j]) {
+					point[j] = index[j] == intervals[j] ? x[j]
+							: a[j] + index[j] * dx[j];
+					return;
+				}
+				index[j] = 0;
+				point[j] = a[j];
+			}
+		};
+
+		if(!this->batch) {
+			Real sum = 0.;
+			for(std::intmax_t k = 0; k < Nodes::value; ++k, next()) {
+				sum += w(k) * packAndCall<Dimension>(
+						this->function, point);
+			}
+			return scale * sum;
+		}
+
+		Abscissae<Dimension> nodes(Nodes::value, Dimension);
+		for(std::intmax_t k = 0; k < Nodes::value; ++k, next()) {
+			for(Index j = 0; j < Dimension; ++j) {
+				nodes(k, j) = point[j];
+			}
+		}
+
+		return scale * w.dot( this->batch(nodes) );
 	}
 
 public:
@@ -349,6 +468,165 @@ using TrapezoidalRule3 = TrapezoidalRule<3, Intervals1, Intervals2, Intervals3>;
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * The 15-point Gauss-Kronrod rule in one dimension. The nodes of the embedded
+ * 7-point Gauss rule are a subset of the Kronrod nodes, so that the difference
+ * between the two rules provides an estimate of the error at the cost of no
+ * additional function evaluations.
+ *
+ * When used by QuantPDE::AdaptiveQuadrature, an interval is bisected only if
+ * this estimate is not within tolerance.
+ * @see QuantPDE::Integral
+ */
+class GaussKronrodRule1 : public Integral<1> {
+
+	virtual Real compute(const std::array<Real, 1> &a,
+			const std::array<Real, 1> &x) const {
+		Real error;
+		return estimate([this] (const Abscissae<1> &y) {
+			return this->evaluate(y);
+		}, a[0], x[0], error);
+	}
+
+public:
+
+	/**
+	 * Constructor.
+	 */
+	template <typename F, typename ...Ts>
+	GaussKronrodRule1(F &&function, Ts ...a) noexcept
+			: Integral<1>(std::forward<F>(function), a...) {
+	}
+
+	/**
+	 * Copy constructor.
+	 */
+	GaussKronrodRule1(const GaussKronrodRule1 &that) noexcept
+			: Integral<1>(that) {
+	}
+
+	/**
+	 * Move constructor.
+	 */
+	GaussKronrodRule1(GaussKronrodRule1 &&that) noexcept
+			: Integral<1>(std::move(that)) {
+	}
+
+	/**
+	 * Applies the rule on an interval.
+	 * @param evaluate Evaluates the integrand on a batch of abscissae (see
+	 *                 QuantPDE::BatchFunction).
+	 * @param a Lower bound of integration.
+	 * @param x Upper bound of integration.
+	 * @param error Set to an estimate of the absolute error.
+	 * @return The Kronrod approximation of the integral.
+	 */
+	template <typename G>
+	static Real estimate(const G &evaluate, Real a, Real x, Real &error) {
+		// Kronrod nodes on [-1, 1] (odd indices are the Gauss nodes)
+		static constexpr Real nodes[8] = {
+			0.991455371120812639206854697526329,
+			0.949107912342758524526189684047851,
+			0.864864423359769072789712788640926,
+			0.741531185599394439863864773280788,
+			0.586087235467691130294144845693013,
+			0.405845151377397166906606412076961,
+			0.207784955007898467600689403773245,
+			0.000000000000000000000000000000000
+		};
+
+		// Kronrod weights
+		static constexpr Real kronrod[8] = {
+			0.022935322010529224963732008058970,
+			0.063092092629978553290700663189204,
+			0.104790010322250183839876322541518,
+			0.140653259715525918745189590510238,
+			0.169004726639267902826583426598550,
+			0.190350578064785409913256402421014,
+			0.204432940075298892414161999234649,
+			0.209482141084727828012999174891714
+		};
+
+		// Gauss weights
+		static constexpr Real gauss[4] = {
+			0.129484966168869693270611432679082,
+			0.279705391489276667901467771423780,
+			0.381830050505118944950369775488975,
+			0.417959183673469387755102040816327
+		};
+
+		const Real center = (a + x) / 2.;
+		const Real radius = (x - a) / 2.;
+
+		Abscissae<1> y(15);
+		y(0) = center;
+		for(int i = 0; i < 7; ++i) {
+			y(2 * i + 1) = center - radius * nodes[i];
+			y(2 * i + 2) = center + radius * nodes[i];
+		}
+
+		const Vector values = evaluate(y);
+
+		Real k = kronrod[7] * values(0);
+		Real g = gauss[3] * values(0);
+
+		for(int i = 0; i < 7; ++i) {
+			const Real f = values(2 * i + 1) + values(2 * i + 2);
+			k += kronrod[i] * f;
+			if(i % 2) {
+				g += gauss[i / 2] * f;
+			}
+		}
+
+		error = std::abs((k - g) * radius);
+		return k * radius;
+	}
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Determines whether a rule provides an estimate of its own error through a
+ * static estimate(evaluate, a, x, error) method.
+ * @see QuantPDE::GaussKronrodRule1
+ */
+template <typename T, typename = void>
+struct HasErrorEstimate : std::false_type {
+};
+
+template <typename T>
+struct HasErrorEstimate<T, decltype(void(&T::template estimate<
+		BatchFunction<1>>))> : std::true_type {
+};
+
+/**
+ * Determines whether a rule only evaluates the integrand at the corners of a
+ * cell (i.e. the trapezoidal rule with a single interval per axis), so that the
+ * evaluations at the corners shared by a cell and its subcells can be reused.
+ * @see QuantPDE::TrapezoidalRule
+ */
+template <typename T>
+struct EvaluatesCornersOnly : std::false_type {
+};
+
+template <Index Dimension, int ...Intervals>
+struct EvaluatesCornersOnly<TrapezoidalRule<Dimension, Intervals...>>
+		: std::integral_constant<bool, IntegerProduct<(Intervals + 1)...>
+		::value == IntegerPower<2, Dimension>::value> {
+};
+
+/**
+ * Adaptively refines the cells on which the rule T is applied until the
+ * integral is within tolerance. If T provides an error estimate (see
+ * QuantPDE::HasErrorEstimate), a cell is refined only if its estimate is not
+ * within tolerance. Otherwise, the integral on a cell is compared to the sum of
+ * the integrals on its subcells; if T only evaluates the integrand at the
+ * corners of a cell (see QuantPDE::EvaluatesCornersOnly), the values at the
+ * corners of a cell are passed down to its subcells rather than recomputed.
+ * @tparam Dimension \f$n\f$.
+ * @tparam T The rule.
+ */
 template <Index Dimension, typename T>
 class AdaptiveQuadrature : public Integral<Dimension> {
 
@@ -358,6 +636,11 @@ class AdaptiveQuadrature : public Integral<Dimension> {
 
 	template <int ...Indices>
 	inline Real packAndCall(const Real *array, Sequence<Indices...>) const {
+		if(this->batch) {
+			return T(this->batch, array[Indices]...)(
+					array[Indices + Dimension]...);
+		}
+
 		return T(this->function, array[Indices]...)(
 				array[Indices + Dimension]...);
 	}
@@ -381,7 +664,7 @@ class AdaptiveQuadrature : public Integral<Dimension> {
 				const Real a = p[j];
 				const Real x = p[j+Dimension];
 
-				if(i && (1 << j)) {
+				if(i & (1 << j)) {
 					// j-th bit of i is 1
 					pp[i][j] = (a + x) / 2.;
 					pp[i][j+Dimension] = x;
@@ -440,8 +723,171 @@ class AdaptiveQuadrature : public Integral<Dimension> {
 		return sum;
 	}
 
-	virtual Real compute(const std::array<Real, Dimension> &a,
-			const std::array<Real, Dimension> &x) const {
+	/**
+	 * Same as refine for rules that only evaluate the integrand at the
+	 * corners of a cell.
+	 * @param previous The integral on the cell.
+	 * @param p The lower bounds of the cell followed by its upper bounds.
+	 * @param corners The integrand at the corners of the cell (the j-th
+	 *                bit of the index of a corner is set if and only if
+	 *                its j-th coordinate is the upper bound).
+	 * @param n The remaining depth.
+	 */
+	Real refineCorners(Real previous, const Real *p, const Real *corners,
+			int n = maxDepth) const {
+		// 2^Dimension corners per cell, 3^Dimension nodes on the
+		// corners of the subcells (each coordinate being the lower
+		// bound, midpoint or upper bound of the cell)
+		typedef IntegerPower<2, Dimension> Power;
+		typedef IntegerPower<3, Dimension> Lattice;
+
+		Real values[Lattice::value];
+
+		// Only the nodes which are not corners of the cell are evaluated
+		Abscissae<Dimension> nodes(Lattice::value - Power::value,
+				Dimension);
+		std::intmax_t fresh[Lattice::value];
+		Index count = 0;
+		for(std::intmax_t k = 0; k < Lattice::value; ++k) {
+			std::intmax_t corner = 0, m = k;
+			bool shared = true;
+			for(Index j = 0; j < Dimension; ++j, m /= 3) {
+				if(m % 3 == 1) {
+					shared = false;
+				} else if(m % 3 == 2) {
+					corner |= 1 << j;
+				}
+			}
+
+			if(shared) {
+				values[k] = corners[corner];
+				continue;
+			}
+
+			m = k;
+			for(Index j = 0; j < Dimension; ++j, m /= 3) {
+				nodes(count, j) = m % 3 == 0 ? p[j]
+						: m % 3 == 2 ? p[j + Dimension]
+						: (p[j] + p[j + Dimension]) / 2.;
+			}
+			fresh[count++] = k;
+		}
+
+		const Vector evaluated = this->evaluate(nodes);
+		for(Index i = 0; i < count; ++i) {
+			values[fresh[i]] = evaluated(i);
+		}
+
+		Real scale = 1. / Power::value;
+		for(Index j = 0; j < Dimension; ++j) {
+			scale *= (p[j + Dimension] - p[j]) / 2.;
+		}
+
+		// Subcell c has the corner b at the node whose j-th coordinate
+		// is (j-th bit of c) + (j-th bit of b)
+		Real subcorners[Power::value][Power::value];
+		Real integrals[Power::value];
+		Real sum = 0.;
+		for(std::intmax_t c = 0; c < Power::value; ++c) {
+			Real total = 0.;
+			for(std::intmax_t b = 0; b < Power::value; ++b) {
+				std::intmax_t k = 0, stride = 1;
+				for(Index j = 0; j < Dimension; ++j) {
+					k += ( ((c >> j) & 1) + ((b >> j) & 1) )
+							* stride;
+					stride *= 3;
+				}
+				subcorners[c][b] = values[k];
+				total += values[k];
+			}
+			integrals[c] = scale * total;
+			sum += integrals[c];
+		}
+
+		const Real error = std::abs((sum - previous)/sum);
+
+		if( n > 0 && error > tolerance ) {
+			sum = 0.;
+
+			Real pp[Dimension * 2];
+			for(std::intmax_t c = 0; c < Power::value; ++c) {
+				for(Index j = 0; j < Dimension; ++j) {
+					const Real a = p[j];
+					const Real x = p[j + Dimension];
+					const Real mid = (a + x) / 2.;
+					pp[j] = (c >> j) & 1 ? mid : a;
+					pp[j + Dimension] = (c >> j) & 1 ? x
+							: mid;
+				}
+				sum += refineCorners(integrals[c], pp,
+						subcorners[c], n - 1);
+			}
+		}
+
+		return sum;
+	}
+
+	Real bisect(Real a, Real x, int n = maxDepth) const {
+		Real error;
+		const Real integral = T::estimate([this] (const Abscissae<1> &y) {
+			return this->evaluate(y);
+		}, a, x, error);
+
+		if( n > 0 && error > tolerance * std::abs(integral) ) {
+			const Real c = (a + x) / 2.;
+			return bisect(a, c, n - 1) + bisect(c, x, n - 1);
+		}
+
+		return integral;
+	}
+
+	Real integrate(const std::array<Real, Dimension> &a,
+			const std::array<Real, Dimension> &x, std::true_type)
+			const {
+		static_assert(Dimension == 1, "Error estimates are only "
+				"available in one dimension");
+		return bisect(a[0], x[0]);
+	}
+
+	Real integrate(const std::array<Real, Dimension> &a,
+			const std::array<Real, Dimension> &x, std::false_type)
+			const {
+		return integrateCells(a, x, EvaluatesCornersOnly<T>());
+	}
+
+	Real integrateCells(const std::array<Real, Dimension> &a,
+			const std::array<Real, Dimension> &x, std::true_type)
+			const {
+		typedef IntegerPower<2, Dimension> Power;
+
+		Real p[Dimension * 2];
+		Real scale = 1. / Power::value;
+		for(Index j = 0; j < Dimension; ++j) {
+			p[j] = a[j];
+			p[j+Dimension] = x[j];
+			scale *= x[j] - a[j];
+		}
+
+		// Outermost integration
+		Abscissae<Dimension> nodes(Power::value, Dimension);
+		for(std::intmax_t b = 0; b < Power::value; ++b) {
+			for(Index j = 0; j < Dimension; ++j) {
+				nodes(b, j) = (b >> j) & 1 ? x[j] : a[j];
+			}
+		}
+
+		const Vector evaluated = this->evaluate(nodes);
+		Real corners[Power::value];
+		for(std::intmax_t b = 0; b < Power::value; ++b) {
+			corners[b] = evaluated(b);
+		}
+
+		return refineCorners(scale * evaluated.sum(), p, corners);
+	}
+
+	Real integrateCells(const std::array<Real, Dimension> &a,
+			const std::array<Real, Dimension> &x, std::false_type)
+			const {
 		// Outermost integration
 		Real p[Dimension * 2];
 		for(Index j = 0; j < Dimension; ++j) {
@@ -455,6 +901,11 @@ class AdaptiveQuadrature : public Integral<Dimension> {
 		return refine(integral, p);
 	}
 
+	virtual Real compute(const std::array<Real, Dimension> &a,
+			const std::array<Real, Dimension> &x) const {
+		return integrate(a, x, HasErrorEstimate<T>());
+	}
+
 	Real tolerance;
 
 public:
@@ -488,7 +939,7 @@ public:
 	 * Copy constructor.
 	 */
 	AdaptiveQuadrature(const AdaptiveQuadrature &that) noexcept
-			: Integral<Dimension>(that) {
+			: Integral<Dimension>(that), tolerance(that.tolerance) {
 	}
 
 	/**
@@ -6,6 +6,7 @@
 #include <memory>  // std::unique_ptr
 #include <tuple>   // std::tuple
 #include <utility> // std::forward, std::move
+#include <vector>  // std::vector
 
 namespace QuantPDE {
 
@@ -36,6 +37,26 @@ public:
 	virtual Real interpolate(const std::array<Real, Dimension> &coordinates)
 			const = 0;
 
+	/**
+	 * Performs interpolation to query the values at many points at once.
+	 * Implementations are encouraged to override this, e.g. to exploit
+	 * queries that are sorted.
+	 * @param points The points, one per row.
+	 * @param values Resized and filled with the interpolated values.
+	 */
+	virtual void interpolate(const Points<Dimension> &points,
+			Vector &values) const {
+		values.resize(points.rows());
+
+		std::array<Real, Dimension> coordinates;
+		for(Index k = 0; k < points.rows(); ++k) {
+			for(Index d = 0; d < Dimension; ++d) {
+				coordinates[d] = points(k, d);
+			}
+			values(k) = interpolate(coordinates);
+		}
+	}
+
 	/**
 	 * Performs interpolation to query the value at the specified
 	 * coordinates.
@@ -70,6 +91,11 @@ public:
 		return p->interpolate(coordinates);
 	}
 
+	virtual void interpolate(const Points<Dimension> &points,
+			Vector &values) const {
+		p->interpolate(points, values);
+	}
+
 	template <typename ...Ts>
 	Real operator()(Ts ...coordinates) const {
 		return (*p)(coordinates...);
@@ -161,6 +187,24 @@ inline std::tuple<Real, Real> linearInterpolationData(const Axis &x, Real ci) {
 		return std::make_tuple(length - 2, 0.);
 	}
 
+	if(x.isUniform()) {
+		// Locate the tick directly and correct for roundoff
+		Index i = (Index) ( (ci - x[0]) * (length - 1)
+				/ (x[length - 1] - x[0]) );
+		if(i > length - 2) {
+			i = length - 2;
+		}
+		while(i > 0 && ci < x[i]) {
+			--i;
+		}
+		while(i < length - 2 && ci >= x[i + 1]) {
+			++i;
+		}
+
+		return std::make_tuple(i, ( x[i + 1] - ci )
+				/ ( x[i + 1] - x[i] ));
+	}
+
 	// Binary search to find tick
 	Index lo = 0, hi = length - 2, mid = 0;
 	Real weight = 0.;
@@ -180,6 +224,116 @@ inline std::tuple<Real, Real> linearInterpolationData(const Axis &x, Real ci) {
 	return std::make_tuple(mid, weight);
 }
 
+/**
+ * Locates many points on an axis at once. For each point, computes the index i
+ * of the tick such that the point lies in [x_i, x_{i+1}) along with the weight
+ * on x_i (points outside of the axis are clamped).
+ *
+ * On uniform axes, each point is located in constant time. Otherwise, a cursor
+ * is kept between queries so that sorted queries are located in amortized
+ * constant time; unsorted queries fall back to a binary search.
+ *
+ * @param x The axis.
+ * @param coordinates The points.
+ * @param count The number of points.
+ * @param indices Output array of size count.
+ * @param weights Output array of size count.
+ */
+inline void linearInterpolationData(const Axis &x, const Real *coordinates,
+		Index count, Index *indices, Real *weights) {
+	const Index length = x.size();
+	const Real *t = x.ticks();
+
+	if(length < 2) {
+		for(Index k = 0; k < count; ++k) {
+			indices[k] = 0;
+			weights[k] = 1.;
+		}
+		return;
+	}
+
+	const Index last = length - 2;
+
+	if(x.isUniform()) {
+		const Real inverse = (length - 1) / (t[length - 1] - t[0]);
+		for(Index k = 0; k < count; ++k) {
+			const Real ci = coordinates[k];
+
+			// Clamp before converting to an index; the quotient of
+			// a point far from the axis does not fit in an Index
+			Index i;
+			if(ci <= t[0]) {
+				i = 0;
+			} else if(ci >= t[length - 1]) {
+				i = last;
+			} else {
+				i = (Index) ((ci - t[0]) * inverse);
+				if(i > last) {
+					i = last;
+				}
+			}
+			while(i > 0 && ci < t[i]) {
+				--i;
+			}
+			while(i < last && ci >= t[i + 1]) {
+				++i;
+			}
+			indices[k] = i;
+		}
+	} else {
+		Index i = 0;
+		for(Index k = 0; k < count; ++k) {
+			const Real ci = coordinates[k];
+
+			if(ci < t[i]) {
+				// Moved backwards; bisect
+				Index lo = 0, hi = i;
+				while(hi - lo > 1) {
+					const Index mid = (lo + hi) / 2;
+					if(ci < t[mid]) {
+						hi = mid;
+					} else {
+						lo = mid;
+					}
+				}
+				i = lo;
+			} else if(i < last && ci >= t[i + 1]) {
+				// Moved forwards; check the next few ticks
+				// before bisecting
+				Index steps = 0;
+				do {
+					++i;
+				} while(i < last && ci >= t[i + 1]
+						&& ++steps < 4);
+
+				if(i < last && ci >= t[i + 1]) {
+					Index lo = i + 1, hi = length - 1;
+					while(hi - lo > 1) {
+						const Index mid = (lo + hi)
+								/ 2;
+						if(ci < t[mid]) {
+							hi = mid;
+						} else {
+							lo = mid;
+						}
+					}
+					i = lo < last ? lo : last;
+				}
+			}
+
+			indices[k] = i;
+		}
+	}
+
+	// Weights are computed in a separate pass so that it vectorizes
+	for(Index k = 0; k < count; ++k) {
+		const Index i = indices[k];
+		const Real w = ( t[i + 1] - coordinates[k] )
+				/ ( t[i + 1] - t[i] );
+		weights[k] = w < 0. ? 0. : (w > 1. ? 1. : w);
+	}
+}
+
 template <Index Dimension>
 inline auto linearInterpolationData(
 	const RectilinearGrid<Dimension> &grid,
@@ -357,10 +511,7 @@ public:
 			//		::index, idxs);
 
 			// n-Dimensional
-			NaryMethodConst<Index, RectilinearGrid<Dimension>,
-					Dimension, Index> tmp =
-					&RectilinearGrid<Dimension>::index;
-			Index k = packAndCall<Dimension>(grid, tmp, idxs);
+			const Index k = grid.index(idxs);
 
 			// Check if this weight is bigger than epsilon;
 			// This way, if an adjacent cell has the value inf or
@@ -374,6 +525,55 @@ public:
 		return interpolated;
 	}
 
+	virtual void interpolate(const Points<Dimension> &points,
+			Vector &values) const {
+		const Index count = points.rows();
+		values.resize(count);
+
+		// Locate the points on each axis
+		std::vector<Index> indices(count * Dimension);
+		std::vector<Real> weights(count * Dimension);
+		for(Index d = 0; d < Dimension; ++d) {
+			linearInterpolationData(
+				grid[d],
+				points.col(d).data(),
+				count,
+				indices.data() + d * count,
+				weights.data() + d * count
+			);
+		}
+
+		typedef IntegerPower<2, Dimension> TwoToTheDimension;
+		for(Index k = 0; k < count; ++k) {
+			Real interpolated = 0.;
+
+			for(std::intmax_t i = 0; i < TwoToTheDimension::value;
+					++i) {
+				Real factor = 1.;
+				Index index = 0;
+
+				for(Index j = 0; j < Dimension; ++j) {
+					const Index l = indices[j * count + k];
+					const Real w = weights[j * count + k];
+					if(i & (1 << j)) {
+						index += l * grid.stride(j);
+						factor *= w;
+					} else {
+						index += (l + 1) * grid.stride(j);
+						factor *= 1. - w;
+					}
+				}
+
+				// See above
+				if(factor > QuantPDE::epsilon) {
+					interpolated += factor * vector[index];
+				}
+			}
+
+			values(k) = interpolated;
+		}
+	}
+
 	class Factory : public InterpolantFactory<Dimension> {
 
 		const RectilinearGrid<Dimension> grid;
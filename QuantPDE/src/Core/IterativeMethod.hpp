@@ -3,12 +3,13 @@
 
 #include <array>         // std::array
 #include <cstdlib>       // std::abs, size_t
+#include <iterator>      // std::prev
 #include <list>          // std::list
+#include <map>           // std::map
 #include <memory>        // std::shared_ptr, std::unique_ptr
-#include <queue>         // std::priority_queue
 #include <tuple>         // std::tuple
 #include <unordered_map> // std::unordered_map
-#include <utility>       // std::forward, std::move
+#include <utility>       // std::forward, std::move, std::pair
 #include <vector>        // std::vector
 
 namespace QuantPDE {
@@ -709,6 +710,112 @@ typedef RawControlledLinearSystem<1, 3> RawControlledLinearSystem1_3;
 typedef RawControlledLinearSystem<2, 3> RawControlledLinearSystem2_3;
 typedef RawControlledLinearSystem<3, 3> RawControlledLinearSystem3_3;
 
+/**
+ * An extension of a controllable linear system that can assemble
+ * \f$A(\mathbf{q})\f$ and \f$b(\mathbf{q})\f$ one row at a time, where
+ * \f$\mathbf{q}\f$ is a control that is the same at every node. This is much
+ * cheaper than assembling \f$A(\mathbf{q})\f$ and \f$b(\mathbf{q})\f$ in
+ * full for each candidate control when searching for an optimal one, or when
+ * only a few rows change control.
+ * @see QuantPDE::PolicyIteration
+ */
+template <Index ControlDimension>
+class RowwiseControlledLinearSystem {
+
+public:
+
+	/**
+	 * A nonzero entry of a row of \f$A\f$.
+	 */
+	typedef std::pair<Index, Real> Entry;
+
+protected:
+
+	/**
+	 * Computes the inner product of a row of \f$A\f$ with a vector. The
+	 * entries are summed in increasing order of their columns, as in a
+	 * (row-major) sparse matrix-vector product, so that the result agrees
+	 * with the full product exactly.
+	 * @param entries The nonzero entries of the row.
+	 * @param count The number of entries.
+	 * @param x The vector.
+	 */
+	static Real rowProduct(Entry *entries, int count, const Vector &x) {
+		// Insertion sort; rows have only a few entries
+		for(int i = 1; i < count; ++i) {
+			const Entry entry = entries[i];
+			int j = i;
+			while(j > 0 && entries[j - 1].first > entry.first) {
+				entries[j] = entries[j - 1];
+				--j;
+			}
+			entries[j] = entry;
+		}
+
+		Real product = 0.;
+		for(int i = 0; i < count; ++i) {
+			product += entries[i].second * x(entries[i].first);
+		}
+		return product;
+	}
+
+public:
+
+	/**
+	 * A control.
+	 */
+	typedef std::array<Real, ControlDimension> Control;
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~RowwiseControlledLinearSystem() {
+	}
+
+	/**
+	 * Computes a single row of \f$A(\mathbf{q})\f$ and
+	 * \f$b(\mathbf{q})\f$. The result must agree exactly with A(time)
+	 * and b(time) when the control at this row is \f$\mathbf{q}\f$. This
+	 * may be called concurrently on distinct rows.
+	 * @param time The time.
+	 * @param control The control.
+	 * @param row The row.
+	 * @param entries The nonzero entries of the row (in any order) are
+	 *                appended to this.
+	 * @return The entry of \f$b(\mathbf{q})\f$ at this row.
+	 */
+	virtual Real row(Real time, const Control &control, Index row,
+			std::vector<Entry> &entries) = 0;
+
+	/**
+	 * For each row in [begin, end) and each control, computes the
+	 * corresponding entry of \f$A(\mathbf{q})x - b(\mathbf{q})\f$. This
+	 * may be called concurrently on disjoint ranges of rows.
+	 * @param time The time.
+	 * @param x The vector.
+	 * @param controls The controls.
+	 * @param begin The first row.
+	 * @param end One past the last row.
+	 * @param residuals On output, the residual for the r-th row and c-th
+	 *                  control is at index (r - begin) * controls.size()
+	 *                  + c.
+	 */
+	virtual void residuals(Real time, const Vector &x,
+			const std::vector<Control> &controls, Index begin,
+			Index end, Real *residuals) {
+		std::vector<Entry> entries;
+		for(Index i = begin; i < end; ++i) {
+			for(const Control &control : controls) {
+				entries.clear();
+				const Real b = row(time, control, i, entries);
+				*(residuals++) = rowProduct(entries.data(),
+						entries.size(), x) - b;
+			}
+		}
+	}
+
+};
+
 /**
  * A controllable linear system using wrappers as the controls.
  * @see QuantPDE::Controllable
@@ -1203,6 +1310,180 @@ inline Real relativeError(const Vector &a, const Vector &b,
 		return this->iterand(0); \
 	} while(0)
 
+/**
+ * The iterands an iterative method converged to, one per (outer) time.
+ * @see QuantPDE::IterandHistory
+ */
+class IterandHistoryBase {
+
+public:
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~IterandHistoryBase() {
+	}
+
+	/**
+	 * Records the iterand converged to at the given time.
+	 * @param time The time.
+	 * @param initial The initial iterand.
+	 * @param converged The iterand converged to.
+	 */
+	virtual void record(Real time, const Vector &initial,
+			const Vector &converged) = 0;
+
+	/**
+	 * Replaces the initial iterand at the given time by a better guess, if
+	 * one is available.
+	 * @param time The time.
+	 * @param iterand The initial iterand.
+	 * @return True if and only if the iterand was replaced.
+	 */
+	virtual bool guess(Real time, Vector &iterand) const = 0;
+
+};
+
+/**
+ * The iterands converged to on one level of refinement of a rectilinear grid,
+ * used to guess the initial iterands on the next (finer) level.
+ *
+ * The solution on the coarse level is not itself a good guess, as it is off by
+ * the (coarse) discretization error, which is usually much larger than the
+ * change in the solution over a timestep. Instead, the guess is the iterand
+ * converged to at the previous time on the fine level plus the change of the
+ * coarse solution between the two times (interpolated linearly in time and
+ * then linearly onto the fine grid). On the first solve (e.g. the only one of
+ * a steady state problem), the change is measured from the initial iterand on
+ * the coarse level.
+ *
+ * Starting from a nearly converged iterand saves iterations of policy
+ * iteration and penalty methods on the fine level, as the first policy (resp.
+ * active set) is computed from it, and it is also the initial guess passed to
+ * the linear solver.
+ *
+ * If the initial iterand is not the one converged to previously (e.g. an event
+ * took place in between), no guess is made.
+ *
+ * Each iterand is kept, so that the memory used grows with the number of
+ * timesteps; only record on levels that will be refined further.
+ * @see QuantPDE::ToleranceIteration::setHistory
+ */
+template <Index Dimension>
+class IterandHistory final : public IterandHistoryBase {
+
+	const RectilinearGrid<Dimension> grid;
+	std::shared_ptr<const IterandHistory> coarse;
+	std::map<Real, Vector> iterands;
+	Vector start;
+	Real previous;
+	Points<Dimension> nodes;
+
+	/**
+	 * @return The recorded iterand at the given time, interpolated linearly
+	 *         between the two closest times (the closest one outside of
+	 *         the times recorded).
+	 */
+	Vector iterand(Real time) const {
+		assert(!iterands.empty());
+
+		const auto hi = iterands.lower_bound(time);
+		if(hi == iterands.end()) {
+			return std::prev(hi)->second;
+		}
+		if(hi == iterands.begin() || hi->first == time) {
+			return hi->second;
+		}
+
+		const auto lo = std::prev(hi);
+		const Real theta = (time - lo->first) / (hi->first - lo->first);
+		return (1. - theta) * lo->second + theta * hi->second;
+	}
+
+public:
+
+	/**
+	 * Constructor.
+	 * @param grid The grid on which iterands are recorded.
+	 * @param coarse The history of a coarser level to guess from (or
+	 *               nullptr).
+	 */
+	IterandHistory(
+		const RectilinearGrid<Dimension> &grid,
+		std::shared_ptr<const IterandHistory> coarse = nullptr
+	) noexcept :
+		grid(grid),
+		previous(0.),
+		nodes(grid.size(), Dimension)
+	{
+		for(Index i = 0; i < grid.size(); ++i) {
+			const auto coordinates = grid.coordinates(i);
+			for(Index d = 0; d < Dimension; ++d) {
+				nodes(i, d) = coordinates[d];
+			}
+		}
+
+		setCoarse(std::move(coarse));
+	}
+
+	/**
+	 * Sets the history of the coarser level to guess from. Release it (by
+	 * passing nullptr) once the solve on this level is done.
+	 * @param coarse The history of a coarser level (or nullptr).
+	 */
+	void setCoarse(std::shared_ptr<const IterandHistory> coarse) {
+		this->coarse = std::move(coarse);
+	}
+
+	/**
+	 * @return True if and only if no iterand has been recorded.
+	 */
+	bool empty() const {
+		return iterands.empty();
+	}
+
+	virtual void record(Real time, const Vector &initial,
+			const Vector &converged) {
+		assert(initial.size() == grid.size());
+		assert(converged.size() == grid.size());
+
+		if(iterands.empty()) {
+			start = initial;
+		}
+		iterands[time] = converged;
+		previous = time;
+	}
+
+	virtual bool guess(Real time, Vector &iterand) const {
+		if(!coarse || coarse->empty()) {
+			return false;
+		}
+
+		assert(iterand.size() == grid.size());
+
+		Vector change;
+		if(iterands.empty()) {
+			change = coarse->iterand(time) - coarse->start;
+		} else if(iterand == iterands.at(previous)) {
+			change = coarse->iterand(time)
+					- coarse->iterand(previous);
+		} else {
+			return false;
+		}
+
+		Vector interpolated;
+		PiecewiseLinear<Dimension>(coarse->grid, std::move(change))
+				.interpolate(nodes, interpolated);
+		iterand += interpolated;
+		return true;
+	}
+
+};
+
+typedef IterandHistory<1> IterandHistory1;
+typedef IterandHistory<2> IterandHistory2;
+typedef IterandHistory<3> IterandHistory3;
+
 /**
  * An iterative method that terminates when adjacent iterands are within a
  * certain error tolerance.
@@ -1212,7 +1493,7 @@ class ToleranceIteration final : public Iteration {
 
 private:
 
-	virtual Vector iterateUntilDone(
+	Vector iterate(
 		Vector iterand,
 		IterationNode &root,
 		LinearSolver &solver,
@@ -1222,11 +1503,32 @@ private:
 		QUANT_PDE_TMP_ITERATE_UNTIL_DONE;
 	}
 
+	virtual Vector iterateUntilDone(
+		Vector iterand,
+		IterationNode &root,
+		LinearSolver &solver,
+		Real time,
+		bool initialized
+	) {
+		if(!iterands) {
+			return iterate(std::move(iterand), root, solver, time,
+					initialized);
+		}
+
+		Vector initial = iterand;
+		iterands->guess(time, iterand);
+		Vector converged = iterate(std::move(iterand), root, solver,
+				time, initialized);
+		iterands->record(time, initial, converged);
+		return converged;
+	}
+
 	virtual bool isTimestepTheSame() const {
 		return true;
 	}
 
 	Real tolerance, scale;
+	IterandHistoryBase *iterands;
 
 	virtual int minimumLookback() const {
 		return 2;
@@ -1245,12 +1547,23 @@ public:
 		Real scale = QuantPDE::scale
 	) noexcept :
 		tolerance(tolerance),
-		scale(scale)
+		scale(scale),
+		iterands(nullptr)
 	{
 		assert(tolerance > 0);
 		assert(scale > 0);
 	}
 
+	/**
+	 * Starts each solve from the guess of the given history (if it has
+	 * one) and records the iterand converged to in it.
+	 * @param history The history (or nullptr to disable).
+	 * @see QuantPDE::IterandHistory
+	 */
+	void setHistory(IterandHistoryBase *history) {
+		iterands = history;
+	}
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1262,37 +1575,28 @@ public:
 		dt = -1.; \
 	} while(0)
 
-// Copy the priority queue so this iteration can be used again in the future
-// and add the NullEvent so as to make sure that iteration terminates
+// Hold on to the schedule for the duration of the solve; it is compiled once
+// and shared by all subsequent solves. Its last group of events is always at
+// the terminal time, which makes sure that iteration terminates.
 #undef QUANT_PDE_TMP_OUTER_HEAD
 #define QUANT_PDE_TMP_OUTER_HEAD \
-	PriorityQueue events(this->events); \
-	events.emplace( \
-		std::numeric_limits<unsigned>::max(), \
-		terminalTime(), \
-		std::shared_ptr<EventBase>(new NullEvent{}) \
-	); \
+	const std::shared_ptr<const Schedule> schedule = this->schedule(); \
+	size_t group = 0; \
 	do { \
-		const Real nextEventTime = std::get<1>(events.top());
+		const Real nextEventTime = schedule->time(group);
 
 #undef QUANT_PDE_TMP_OUTER_TAIL
 #define QUANT_PDE_TMP_OUTER_TAIL \
 		this->implicitTime = nextEventTime; \
-		const Vector *current = &this->iterand(0); \
-		Vector transformed; \
-		while(!events.empty() && std::get<1>(events.top()) \
-				== this->implicitTime) { \
-			transformed = (*std::get<2>(events.top()))(*current); \
-			events.pop(); \
-			current = &transformed; \
-		} \
+		Vector transformed = schedule->apply(group++, \
+				this->iterand(0)); \
 		this->afterEvent(); \
 		this->history->clear(); \
 		this->history->push(std::make_tuple( \
 			this->implicitTime, \
 			std::move(transformed) \
 		)); \
-	} while( Order()(terminalTime(), this->implicitTime) )
+	} while( group < schedule->size() )
 
 // TODO: Optimize
 #undef QUANT_PDE_TMP_TIMESTEP
@@ -1331,31 +1635,7 @@ class TimeIteration : public Iteration {
 		std::less<Real>
 	>::type Order;
 
-	typedef std::tuple<
-		unsigned,
-		Real,
-		std::shared_ptr<EventBase>
-	> T;
-
-	struct TimeOrder {
-		// Returns true if a goes before b in the ordering
-		bool operator()(const T &a, const T &b) const {
-			return
-				Order()( std::get<1>(a), std::get<1>(b) )
-				|| (
-					std::get<1>(a) == std::get<1>(b)
-					&& Order()( std::get<0>(a),
-							std::get<0>(b) )
-				)
-			;
-		}
-	};
-
-	// If events are set to the same time, ties are broken depending on the
-	// order they were added. Events added later are assumed to occur later
-	// in time (e.g. handled earlier if Forward == true; later otherwise).
-
-	typedef std::priority_queue<T, std::vector<T>, TimeOrder> PriorityQueue;
+	typedef EventSchedule<Forward> Schedule;
 
 	////////////////////////////////////////////////////////////////////////
 
@@ -1384,12 +1664,59 @@ class TimeIteration : public Iteration {
 	////////////////////////////////////////////////////////////////////////
 
 	unsigned id;
-	PriorityQueue events;
+	std::vector<typename Schedule::Entry> events;
+	std::shared_ptr<const Schedule> compiled;
 
 	Real startTime, endTime, dt, dtPrevious;
 
+	void push(Real time, std::shared_ptr<EventBase> event) {
+		assert(time >= startTime);
+		assert(time <= endTime);
+		assert(time != initialTime());
+
+		events.emplace_back( id++, time, std::move(event) );
+
+		// Recompile on the next solve
+		compiled.reset();
+	}
+
 public:
 
+	/**
+	 * Compiles the events added so far into a schedule. The schedule is
+	 * cached until another event is added.
+	 * @return The event schedule.
+	 */
+	const std::shared_ptr<const Schedule> &schedule() {
+		if(!compiled) {
+			compiled = std::make_shared<const Schedule>(events,
+					terminalTime());
+		}
+		return compiled;
+	}
+
+	/**
+	 * Replaces the events of this iteration with those of a previously
+	 * compiled schedule (e.g. one from another iteration over the same time
+	 * interval). The schedule is shared, not copied.
+	 * @param schedule The event schedule.
+	 */
+	void setSchedule(std::shared_ptr<const Schedule> schedule) {
+		assert(schedule);
+		assert(schedule->time(schedule->size() - 1) == terminalTime());
+
+		events = schedule->events();
+		id = 0;
+		for(const auto &event : events) {
+			assert(std::get<1>(event) != initialTime());
+			if(std::get<0>(event) >= id) {
+				id = std::get<0>(event) + 1;
+			}
+		}
+
+		compiled = std::move(schedule);
+	}
+
 	/**
 	 * Returns the size of the timestep to take.
 	 * @return Size of timestep.
@@ -1413,11 +1740,7 @@ public:
 	 * @param event The event.
 	 */
 	void add(Real time, std::unique_ptr<EventBase> event) {
-		assert(time >= startTime);
-		assert(time <= endTime);
-		assert(time != initialTime());
-
-		events.emplace( id++, time, std::move(event) );
+		push( time, std::move(event) );
 	}
 
 	/**
@@ -1428,12 +1751,7 @@ public:
 	 */
 	template <Index Dimension, typename ...Ts>
 	void add(Real time, Ts &&...args) {
-		assert(time >= startTime);
-		assert(time <= endTime);
-		assert(time != initialTime());
-
-		events.emplace(
-			id++,
+		push(
 			time,
 			std::shared_ptr<EventBase>(
 				new Event<Dimension>(
@@ -1451,11 +1769,7 @@ public:
 #define QUANT_PDE_TMP(DIMENSION) \
 	template <typename ...Ts> \
 	void add(Real time, Transform##DIMENSION &&transform, Ts &&...args) { \
-		assert(time >= startTime); \
-		assert(time <= endTime); \
-		assert(time != initialTime()); \
-		events.emplace( \
-			id++, \
+		push( \
 			time, \
 			std::shared_ptr<EventBase>( \
 				new Event##DIMENSION( \
@@ -1468,11 +1782,7 @@ public:
 	template <typename ...Ts> \
 	void add(Real time, const Transform##DIMENSION &transform, \
 			Ts &&...args) { \
-		assert(time >= startTime); \
-		assert(time <= endTime); \
-		assert(time != initialTime()); \
-		events.emplace( \
-			id++, \
+		push( \
 			time, \
 			std::shared_ptr<EventBase>( \
 				new Event##DIMENSION( \
@@ -1481,6 +1791,18 @@ public:
 				) \
 			) \
 		); \
+	} \
+	void add(Real time, const PointwiseTransform##DIMENSION &transform, \
+			const RectilinearGrid##DIMENSION &grid) { \
+		push( \
+			time, \
+			std::shared_ptr<EventBase>( \
+				new PointwiseEvent##DIMENSION( \
+					transform, \
+					grid \
+				) \
+			) \
+		); \
 	}
 
 	QUANT_PDE_TMP(1)
@@ -1,8 +1,10 @@
 #ifndef QUANT_PDE_CORE_MAP_HPP
 #define QUANT_PDE_CORE_MAP_HPP
 
-#include <memory>  // std::unique_ptr
-#include <utility> // std::forward, std::move
+#include <algorithm> // std::min
+#include <cmath>     // std::abs, std::exp
+#include <memory>    // std::unique_ptr
+#include <utility>   // std::forward, std::move
 
 namespace QuantPDE {
 
@@ -76,20 +78,27 @@ class PointwiseMap final : public Map<Dimension> {
 	typedef std::unique_ptr<Map<Dimension>> M;
 
 	const Domain<Dimension> *domain;
+	unsigned threads;
 
 public:
 
 	/**
 	 * Constructor.
+	 * @param domain The domain.
+	 * @param threads The number of threads used to evaluate the function
+	 *                (0 to use all hardware threads). If this is not 1,
+	 *                the function must be safe to call concurrently.
 	 */
 	template <typename D>
-	PointwiseMap(D &domain) noexcept : domain(&domain) {
+	PointwiseMap(D &domain, unsigned threads = 1) noexcept
+			: domain(&domain), threads(threads) {
 	}
 
 	/**
 	 * Copy constructor.
 	 */
-	PointwiseMap(const PointwiseMap &that) noexcept : domain(that.domain) {
+	PointwiseMap(const PointwiseMap &that) noexcept : domain(that.domain),
+			threads(that.threads) {
 	}
 
 	/**
@@ -97,15 +106,17 @@ public:
 	 */
 	PointwiseMap &operator=(const PointwiseMap &that) & noexcept {
 		domain = that.domain;
+		threads = that.threads;
 		return *this;
 	}
 
 	virtual Vector operator()(const Function<Dimension> &function) const {
-		return domain->image(function);
+		return threads == 1 ? domain->image(function)
+				: domain->parallelImage(function, threads);
 	}
 
 	virtual Vector operator()(Function<Dimension> &&function) const {
-		return domain->image( std::move(function) );
+		return (*this)(function);
 	}
 
 	virtual M clone() const {
@@ -118,108 +129,111 @@ typedef PointwiseMap<1> PointwiseMap1;
 typedef PointwiseMap<2> PointwiseMap2;
 typedef PointwiseMap<3> PointwiseMap3;
 
-#if 0
 /**
- * Performs a convolution with \f$\varphi\left(x/epsilon\right)/\epsilon\f$
- * and maps the result to the grid.
+ * Performs a convolution with
+ * \f$\varphi_\epsilon\left(x\right)\equiv\varphi\left(x/\epsilon\right)/\epsilon\f$,
+ * where \f$\varphi\f$ is supported on \f$\left[-1,1\right]\f$, and maps the
+ * result to the grid.
+ *
+ * The convolution is computed directly at each node of the (possibly
+ * nonuniform) grid by adaptive Gauss-Kronrod quadrature on a fixed number of
+ * panels covering the support, so that the cost is proportional to the number
+ * of nodes (discontinuities of the function only cause additional refinement
+ * on the panels containing them).
+ *
+ * On uniform grids, smoothing a discontinuous payoff with \f$\epsilon\f$ a few
+ * (e.g. four) times the spacing recovers (nearly) second order convergence.
+ * This is not the case on strongly nonuniform grids, where the trapezoidal
+ * rule implicit in the discretization does not conserve the mass of the
+ * smoothed function to second order; use QuantPDE::L2ProjectOnLagrangeBases1
+ * instead.
+ *
+ * Near the ends of the grid, \f$\epsilon\f$ is reduced so that the support
+ * remains within the grid. The mollifier is normalized numerically, so that
+ * constants are preserved.
  */
 class MollifierConvolution1 : public Map1 {
 
-	const RectilinearGrid1 *grid;
-	Function2 mollifier;
-	Real epsilon;
+	typedef std::unique_ptr<Map1> M;
 
-	template <typename F>
-	Vector map(F &&function) const {
-		// 1. Create temporary grid
-		// 2. Perform convolution on temporary grid
-		// 3. Use linear interpolation to transfer the function to the
-		//    grid
+	// The support is split into this many panels
+	static constexpr int panels = 8;
 
-		// TODO: Optimize this. Currently far too slow to use!
-		//       Idea... use an uneven grid?
+	static constexpr int maxDepth = 32;
 
-		////////////////////////////////////////////////////////////////
-		// Creating the temporary Grid
-		////////////////////////////////////////////////////////////////
+	const RectilinearGrid1 *grid;
+	Function1 mollifier;
+	Real epsilon;
 
-		// Left and right endpoints (add four nodes on the ends to
-		// increase accuracy)
-		const Axis &X = (*grid)[0];
-		Real
-			left  = X[0]            - 2 * epsilon,
-			right = X[X.size() - 1] + 2 * epsilon
-		;
-		size_t n = (right - left) / epsilon + 1;
-
-		// Build it
-		Real *ticks = new Real[n];
-		for(size_t i = 0; i < n; ++i) {
-			ticks[i] = left + i * epsilon;
+	// Bisects until the (absolute) error estimate is within tolerance;
+	// a relative criterion would needlessly refine the tails of the
+	// mollifier
+	template <typename F>
+	Real integrate(const F &function, Real a, Real b, Real tolerance,
+			int n = maxDepth) const {
+		Real error;
+		const Real integral = GaussKronrodRule1::estimate(
+				[&] (const Abscissae<1> &s) {
+			Vector values(s.rows());
+			for(Index i = 0; i < s.rows(); ++i) {
+				values(i) = function(s(i));
+			}
+			return values;
+		}, a, b, error);
+
+		if(n > 0 && error > tolerance) {
+			const Real c = (a + b) / 2.;
+			return integrate(function, a, c, tolerance / 2., n - 1)
+					+ integrate(function, c, b,
+					tolerance / 2., n - 1);
 		}
-		RectilinearGrid1 tmp( Axis(ticks, n) );
-		delete [] ticks;
-		ticks = nullptr;
-
-		////////////////////////////////////////////////////////////////
-		// Convolution and linear interpolation
-		////////////////////////////////////////////////////////////////
-
-		Vector u = tmp.image( std::forward<F>(function) );
 
-		Vector v = tmp.image([&] (Real x) {
-			return mollifier(epsilon, x - (left + right) / 2.);
-		}) * epsilon;
-
-		////////////////////////////////////////////////////////////////
-		// FFT
-		////////////////////////////////////////////////////////////////
-
-		Eigen::FFT<Real> fft;
-
-		std::vector<Real> u0, v0;
-		for(size_t i = 0; i < n; ++i) {
-			u0.push_back( (u.data())[i] );
-			v0.push_back( (v.data())[i] );
-		}
+		return integral;
+	}
 
-		// Pad with zeros
-		for(size_t i = 0; i < n - 1; ++i) {
-			u0.push_back( 0. );
-			v0.push_back( 0. );
+	template <typename F>
+	Real convolve(const F &function, Real x, Real epsilon,
+			Real tolerance) const {
+		Real sum = 0.;
+		for(int k = 0; k < panels; ++k) {
+			sum += integrate([&] (Real s) {
+				return mollifier(s) * function(x - epsilon * s);
+			}, -1. + 2. * k / panels, -1. + 2. * (k + 1) / panels,
+			tolerance / panels);
 		}
+		return sum;
+	}
 
-		std::vector<std::complex<Real>> uk, vk;
-
-		// Forward transform
-		fft.fwd(uk, u0);
-		fft.fwd(vk, v0);
+	template <typename F>
+	Vector map(F &&function) const {
+		const Axis &X = (*grid)[0];
+		const Index n = X.size();
 
-		// Component-wise multiplication
-		for(size_t i = 0; i < uk.size(); ++i) {
-			uk[i] = uk[i] * vk[i];
-		}
+		const Real mass = convolve([] (Real) { return 1.; }, 0., 0.,
+				QuantPDE::epsilon);
 
-		// Inverse transform
-		fft.inv(u0, uk);
+		Vector v = grid->vector();
+		for(Index i = 0; i < n; ++i) {
+			const Real e = std::min( epsilon, std::min(X[i] - X[0],
+					X[n - 1] - X[i]) );
+			const Real f = function(X[i]);
 
-		// Transfer data to a vector
-		Vector w = tmp.vector();
-		for(size_t i = 0; i < n; ++i) {
-			w(i) = u0[i + n/2];
+			v(i) = e > 0. ? convolve(function, X[i], e,
+					QuantPDE::tolerance * mass
+					* (1. + std::abs(f))) / mass : f;
 		}
 
-		////////////////////////////////////////////////////////////////
-
-		// Transfer the function to the original grid via piecewise
-		// linear interpolation and return it
-		return grid->image( PiecewiseLinear1(tmp, w) );
+		return v;
 	}
 
 public:
 
 	/**
 	 * Constructor.
+	 * @param grid The grid.
+	 * @param mollifier The function \f$\varphi\f$, supported on
+	 *                  \f$\left[-1,1\right]\f$ (need not be normalized).
+	 * @param epsilon The radius of the support of \f$\varphi_\epsilon\f$.
 	 */
 	template <typename G, typename F>
 	MollifierConvolution1(G &grid, F &&mollifier, Real epsilon) noexcept
@@ -281,17 +295,23 @@ public:
 		return map( std::move(function) );
 	}
 
+	virtual M clone() const {
+		return M(new MollifierConvolution1(*this));
+	}
+
 };
 
 /**
- * Uses the function \f$\varphi\left(x\right)\equiv e^{-x^2}/\sqrt{\pi}\f$ as a
- * mollifier.
- * Note that technically, this is not a mollifier (it does not have compact
- * support).
+ * Uses the standard mollifier
+ * \f$\varphi\left(x\right)\propto e^{-1/\left(1-x^2\right)}\f$ for
+ * \f$\left|x\right|<1\f$ (and zero elsewhere), so that the convolution tends
+ * to the function itself as \f$\epsilon\rightarrow0\f$.
  * @see QuantPDE::MollifierConvolution1
  */
 class DiracConvolution1 final : public MollifierConvolution1 {
 
+	typedef std::unique_ptr<Map1> M;
+
 public:
 
 	/**
@@ -301,89 +321,81 @@ public:
 	DiracConvolution1(G &grid, Real epsilon) noexcept
 			: MollifierConvolution1(
 				grid,
-				[] (Real a, Real x) {
-					return 1 / (a * std::sqrt(M_PI))
-							* std::exp( -(x * x)
-							/ (a * a) );
+				[] (Real x) {
+					return std::abs(x) < 1.
+							? std::exp(-1. / (1.
+							- x * x)) : 0.;
 				},
 				epsilon
 			) {
 	}
 
+	virtual M clone() const {
+		return M(new DiracConvolution1(*this));
+	}
+
 };
-#endif
 
 // TODO: Generalize this for n-dimensions
 class L2ProjectOnLagrangeBases1 final : public Map1 {
 
 	typedef std::unique_ptr<Map1> M;
+	typedef AdaptiveQuadrature1<GaussKronrodRule1> Integral;
 
 	const RectilinearGrid1 *G;
 
 	template <typename F1>
 	Vector map(F1 &&f) const {
-		Matrix M(G->size(), G->size());
-		M.reserve( IntegerVector::Constant(G->size(), 3) );
-
 		const Axis &S = (*G)[0];
 		const Index n = S.size();
 
+		// The mass matrix is tridiagonal, with subdiagonal L, diagonal
+		// D, and superdiagonal U
+		Vector L = G->vector(), D = G->vector(), U = G->vector();
 		Vector F = G->vector();
 
-		M.insert(0, 0) = 2. * (S[1] - S[0]) / 6.;
-		M.insert(0, 1) =      (S[1] - S[0]) / 6.;
-
-		F(0) =
-			(S[1] - S[0]) / 2. * (
-				  4. / 6. * std::forward<F1>(f)(
-				  		(S[0] + S[1]) / 2.)
-				+ 1. / 3. * std::forward<F1>(f)( S[0] )
-			)
-		;
+		D(0) = 2. * (S[1] - S[0]) / 6.;
+		U(0) =      (S[1] - S[0]) / 6.;
 
 		for(Index i = 1; i < n - 1; ++i) {
-			M.insert(i, i - 1) =      (S[i    ] - S[i - 1]) / 6.;
-			M.insert(i, i    ) = 2. * (S[i + 1] - S[i - 1]) / 6.;
-			M.insert(i, i + 1) =      (S[i + 1] - S[i    ]) / 6.;
-
-			// TODO: Allow for any form of quadrature
-			//       (Currently just Simpson's rule)
-			F(i) =
-				  (S[i] - S[i - 1]) / 2. * (
-					  4. / 6. * std::forward<F1>(f)(
-					  		(S[i - 1] + S[i]) / 2.)
-					+ 1. / 3. * std::forward<F1>(f)(
-							S[i]
-							- QuantPDE::epsilon)
-				)
-				+ (S[i + 1] - S[i]) / 2. * (
-					  4. / 6. * std::forward<F1>(f)(
-					  		(S[i] + S[i + 1]) / 2.)
-					+ 1. / 3. * std::forward<F1>(f)(
-							S[i]
-							+ QuantPDE::epsilon)
-				)
-			;
+			L(i) =      (S[i    ] - S[i - 1]) / 6.;
+			D(i) = 2. * (S[i + 1] - S[i - 1]) / 6.;
+			U(i) =      (S[i + 1] - S[i    ]) / 6.;
 		}
 
-		M.insert(n - 1, n - 2) =      (S[n - 1] - S[n - 2]) / 6.;
-		M.insert(n - 1, n - 1) = 2. * (S[n - 1] - S[n - 2]) / 6.;
+		L(n - 1) =      (S[n - 1] - S[n - 2]) / 6.;
+		D(n - 1) = 2. * (S[n - 1] - S[n - 2]) / 6.;
 
-		F(n - 1) =
-			(S[n - 1] - S[n - 2]) / 2. * (
-				  4. / 6. * std::forward<F1>(f)(
-				  		(S[n - 2] + S[n - 1]) / 2.)
-				+ 1. / 3. * std::forward<F1>(f)( S[n - 1] )
-			)
-		;
+		// Inner products of the function with the basis functions,
+		// accumulated cell by cell; adaptive quadrature resolves any
+		// discontinuities of the function within a cell
+		F.setZero();
+		for(Index i = 0; i < n - 1; ++i) {
+			const Real a = S[i], b = S[i + 1], h = b - a;
 
-		// TODO: Use tridiagonal solver instead
-		BiCGSTAB solver;
-		solver.compute(M);
-		Vector v = solver.solve(F);
+			F(i) += Integral([&] (Real x) {
+				return f(x) * (b - x) / h;
+			}, a)(b);
 
-		assert( solver.info() == Eigen::Success );
-		return v;
+			F(i + 1) += Integral([&] (Real x) {
+				return f(x) * (x - a) / h;
+			}, a)(b);
+		}
+
+		// Tridiagonal (Thomas) solve; the mass matrix is strictly
+		// diagonally dominant, so no pivoting is required
+		for(Index i = 1; i < n; ++i) {
+			const Real w = L(i) / D(i - 1);
+			D(i) -= w * U(i - 1);
+			F(i) -= w * F(i - 1);
+		}
+
+		F(n - 1) /= D(n - 1);
+		for(Index i = n - 2; i >= 0; --i) {
+			F(i) = (F(i) - U(i) * F(i + 1)) / D(i);
+		}
+
+		return F;
 	}
 
 public:
@@ -391,8 +403,8 @@ public:
 	/**
 	 * Constructor.
 	 */
-	template <typename G>
-	L2ProjectOnLagrangeBases1(G &grid) noexcept : G(&grid) {
+	template <typename T>
+	L2ProjectOnLagrangeBases1(T &grid) noexcept : G(&grid) {
 	}
 
 	/**
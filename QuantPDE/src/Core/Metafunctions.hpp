@@ -171,6 +171,34 @@ struct GenerateSequence<0, Integers...> : Sequence<Integers...> {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Unrolls a loop of a fixed number of iterations at compile-time. For example,
+ * \code{.cpp}
+ * // Calls f(0), f(1), f(2)
+ * Unroll<3>::apply(f);
+ * \endcode
+ * @tparam N The number of iterations.
+ */
+template <int N>
+struct Unroll {
+	template <typename F>
+	static inline void apply(F &&f) {
+		Unroll<N - 1>::apply(f);
+		f(N - 1);
+	}
+};
+
+/** @cond QUANT_PDE_HIDDEN */
+template <>
+struct Unroll<0> {
+	template <typename F>
+	static inline void apply(F &&) {
+	}
+};
+/** @endcond */
+
+////////////////////////////////////////////////////////////////////////////////
+
 /** @cond QUANT_PDE_HIDDEN */
 namespace NaryFunctionSignatureHelpers {
 
@@ -0,0 +1,158 @@
+#ifndef QUANT_PDE_CORE_PARALLEL_HPP
+#define QUANT_PDE_CORE_PARALLEL_HPP
+
+#include <atomic>             // std::atomic
+#include <condition_variable> // std::condition_variable
+#include <cstdint>            // std::intmax_t
+#include <mutex>              // std::mutex, std::unique_lock
+#include <thread>             // std::thread
+#include <vector>             // std::vector
+
+namespace QuantPDE {
+
+/**
+ * @return The number of concurrent threads supported by the hardware (at least
+ *         one).
+ */
+inline unsigned hardwareThreads() {
+	const unsigned threads = std::thread::hardware_concurrency();
+	return threads > 0 ? threads : 1;
+}
+
+/**
+ * Calls f(i) for each i in [begin, end), splitting the range into contiguous
+ * chunks of (nearly) equal size, one per thread. The calling thread handles
+ * the first chunk.
+ *
+ * The partition only depends on the range and the number of threads, and each
+ * index is visited exactly once, so that the result is deterministic as long
+ * as calls with distinct indices do not write to the same location.
+ *
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param threads The number of threads (0 to use hardwareThreads()).
+ * @param f A function that is safe to call concurrently on distinct indices.
+ */
+template <typename F>
+void parallelFor(Index begin, Index end, unsigned threads, const F &f) {
+	if(threads == 0) {
+		threads = hardwareThreads();
+	}
+
+	const Index count = end - begin;
+	if(count <= 0) {
+		return;
+	}
+	if((Index) threads > count) {
+		threads = count;
+	}
+
+	if(threads <= 1) {
+		for(Index i = begin; i < end; ++i) {
+			f(i);
+		}
+		return;
+	}
+
+	auto chunk = [=, &f] (unsigned k) {
+		const Index first = begin + (Index) (
+				(std::intmax_t) count * k / threads );
+		const Index last = begin + (Index) (
+				(std::intmax_t) count * (k + 1) / threads );
+		for(Index i = first; i < last; ++i) {
+			f(i);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(threads - 1);
+	for(unsigned k = 1; k < threads; ++k) {
+		workers.emplace_back(chunk, k);
+	}
+
+	chunk(0);
+
+	for(std::thread &worker : workers) {
+		worker.join();
+	}
+}
+
+/**
+ * Calls f(i) for each i in [begin, end) on a pool of threads, handing out the
+ * indices from the last to the first (e.g. levels of refinement, so that the
+ * most expensive ones start first and the pool is not left waiting on them at
+ * the end). On the calling thread, done(i) is called for each i in increasing
+ * order as soon as f(i) has returned, so that results can be reported in order
+ * while the remaining ones are being computed.
+ *
+ * With a single thread, f(i) and done(i) are called alternately in increasing
+ * order of i on the calling thread.
+ *
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param threads The number of worker threads (0 to use hardwareThreads()).
+ * @param f A function that is safe to call concurrently on distinct indices.
+ * @param done A function called once f(i) has returned.
+ */
+template <typename F, typename G>
+void parallelForInOrder(Index begin, Index end, unsigned threads, const F &f,
+		const G &done) {
+	if(threads == 0) {
+		threads = hardwareThreads();
+	}
+
+	const Index count = end - begin;
+	if(count <= 0) {
+		return;
+	}
+	if((Index) threads > count) {
+		threads = count;
+	}
+
+	if(threads <= 1) {
+		for(Index i = begin; i < end; ++i) {
+			f(i);
+			done(i);
+		}
+		return;
+	}
+
+	std::atomic<Index> next(end);
+	std::vector<char> finished(count, 0);
+	std::mutex mutex;
+	std::condition_variable condition;
+
+	auto work = [&] () {
+		Index i;
+		while((i = --next) >= begin) {
+			f(i);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			finished[i - begin] = 1;
+			condition.notify_one();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(threads);
+	for(unsigned k = 0; k < threads; ++k) {
+		workers.emplace_back(work);
+	}
+
+	for(Index i = begin; i < end; ++i) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [&] { return finished[i - begin]
+					!= 0; });
+		}
+		done(i);
+	}
+
+	for(std::thread &worker : workers) {
+		worker.join();
+	}
+}
+
+}
+
+#endif
@@ -30,6 +30,11 @@ class PenaltyMethod : public IterationNode {
 	Matrix rA, lA;
 	Vector rb, lb;
 
+	// Rows at which P (resp. Q) is nonzero, and whether these are the
+	// same as on the previous iteration
+	std::vector<char> penalized, kept;
+	bool same;
+
 	#ifdef QUANT_PDE_MODULES_HJBQVI_ITERATED_OPTIMAL_STOPPING
 	const bool right_explicit;
 	#endif
@@ -58,6 +63,10 @@ class PenaltyMethod : public IterationNode {
 		Q.reserve( IntegerVector::Constant( domain->size(), 1 ) );
 
 		// Build penalty matrix
+		const bool first = penalized.empty();
+		penalized.resize(domain->size());
+		kept.resize(domain->size());
+		same = !first;
 		for(Index i = 0; i < domain->size(); ++i) {
 			const bool c = Order()(
 				(scale * predicate(i)),
@@ -65,6 +74,10 @@ class PenaltyMethod : public IterationNode {
 			);
 			if(c) { P.insert(i, i) = scale; }
 			if(!direct || !c) { Q.insert(i, i) = 1.; }
+
+			same = same && penalized[i] == c;
+			penalized[i] = c;
+			kept[i] = !direct || !c;
 		}
 	}
 
@@ -85,7 +98,8 @@ public:
 		scale( 1. / tolerance ),
 		direct(direct),
 		P( domain.size(), domain.size() ),
-		Q( domain.size(), domain.size() )
+		Q( domain.size(), domain.size() ),
+		same(false)
 		#ifdef QUANT_PDE_MODULES_HJBQVI_ITERATED_OPTIMAL_STOPPING
 		, right_explicit(right_explicit)
 		#endif
@@ -93,6 +107,11 @@ public:
 		assert(tolerance > 0);
 	}
 
+	virtual bool isATheSame() const {
+		// A only changes if the active set or the constraints do
+		return same && left->isATheSame() && right->isATheSame();
+	}
+
 	virtual Matrix A(Real t) {
 		assert(t == nextTime());
 
@@ -102,7 +121,40 @@ public:
 		}
 		#endif
 
-		return Q * lA + P * rA;
+		// Same as Q * lA + P * rA, merging the rows of lA and rA
+		// directly instead of forming the products
+		lA.makeCompressed();
+		rA.makeCompressed();
+
+		Matrix A(domain->size(), domain->size());
+		A.reserve(lA.nonZeros() + rA.nonZeros());
+
+		for(Index i = 0; i < domain->size(); ++i) {
+			A.startVec(i);
+
+			Matrix::InnerIterator l(lA, i), r(rA, i);
+			const bool keep = kept[i], penalize = penalized[i];
+			while((keep && l) || (penalize && r)) {
+				if(keep && l && (!(penalize && r)
+						|| l.index() < r.index())) {
+					A.insertBack(i, l.index()) = l.value();
+					++l;
+				} else if(!(keep && l)
+						|| r.index() < l.index()) {
+					A.insertBack(i, r.index()) =
+							scale * r.value();
+					++r;
+				} else {
+					A.insertBack(i, l.index()) = l.value()
+							+ scale * r.value();
+					++l;
+					++r;
+				}
+			}
+		}
+		A.finalize();
+
+		return A;
 	}
 
 	virtual Vector b(Real t) {
@@ -256,6 +308,10 @@ class PenaltyMethodDifference : public PenaltyMethod<Max> {
 		{
 		}
 
+		virtual bool isATheSame() const {
+			return true;
+		}
+
 		virtual Matrix A(Real) {
 			return domain->identity();
 		}
@@ -1,9 +1,15 @@
 #ifndef QUANT_PDE_CORE_POLICY_ITERATION_HPP
 #define QUANT_PDE_CORE_POLICY_ITERATION_HPP
 
+#include <algorithm>  // std::sort
+#include <array>      // std::array
 #include <cassert>    // assert
+#include <cstdint>    // std::intmax_t
 #include <functional> // std::greater, std::less
+#include <cstddef>    // std::size_t
 #include <limits>     // std::numeric_limits
+#include <memory>     // std::unique_ptr
+#include <vector>     // std::vector
 
 namespace QuantPDE {
 
@@ -47,9 +53,320 @@ class PolicyIteration : public IterationNode {
 	typedef typename std::conditional<Max, std::greater<Real>,
 			std::less<Real>>::type Order;
 
+	typedef RowwiseControlledLinearSystem<ControlDimension> Rowwise;
+
 	const Domain<Dimension> *domain;
 	const Domain<ControlDimension> *controlDomain;
 	ControlledLinearSystemBase *system;
+	Rowwise *rowwise;
+	const ControlOptimizer<ControlDimension> *optimizer;
+	unsigned threads;
+
+	// Warm start
+	std::unique_ptr<NeighbourhoodSearch<ControlDimension>> warm;
+	std::vector<Index> previous;
+	std::size_t searches, fallbacks;
+
+	// Incremental assembly: A and b for the controls applied at the given
+	// time, and the controls the system was last given
+	Matrix assembledA;
+	Vector assembledB;
+	Vector applied[ControlDimension], current[ControlDimension];
+	Real assembledTime;
+	bool assembled, unchanged;
+
+	/**
+	 * @return The rows at which the current control differs from the one
+	 *         A and b were assembled with.
+	 */
+	std::vector<Index> changedRows() const {
+		std::vector<Index> rows;
+		for(Index i = 0; i < domain->size(); ++i) {
+			for(Index j = 0; j < ControlDimension; ++j) {
+				if(current[j].size() != domain->size()
+						|| applied[j].size()
+						!= domain->size()
+						|| !(current[j](i) ==
+						applied[j](i))) {
+					rows.push_back(i);
+					break;
+				}
+			}
+		}
+		return rows;
+	}
+
+	/**
+	 * Brings A and b up to date with the current controls. Within a
+	 * timestep, only the rows whose control changed since the last call
+	 * are reassembled (unless there are many of them).
+	 */
+	void assemble() {
+		const Real time = nextTime();
+
+		if(assembled && time == assembledTime) {
+			const std::vector<Index> rows = changedRows();
+			if(rows.empty()) {
+				return;
+			}
+
+			if((Index) rows.size() * 2 <= domain->size()) {
+				patch(time, rows);
+				for(Index j = 0; j < ControlDimension; ++j) {
+					applied[j] = current[j];
+				}
+				return;
+			}
+		}
+
+		assembledA = system->A(time);
+		assembledB = system->b(time);
+		assembledA.makeCompressed();
+		for(Index j = 0; j < ControlDimension; ++j) {
+			applied[j] = current[j];
+		}
+		assembledTime = time;
+		assembled = true;
+	}
+
+	/**
+	 * Reassembles the given rows of A and b, copying the others over.
+	 * @param time The time.
+	 * @param rows The rows (in increasing order).
+	 */
+	void patch(Real time, const std::vector<Index> &rows) {
+		typedef typename Rowwise::Entry Entry;
+
+		std::vector<std::vector<Entry>> entries(rows.size());
+		std::vector<Real> values(rows.size());
+		parallelFor(0, rows.size(), threads, [&] (Index k) {
+			typename Rowwise::Control control;
+			for(Index j = 0; j < ControlDimension; ++j) {
+				control[j] = current[j](rows[k]);
+			}
+
+			values[k] = rowwise->row(time, control, rows[k],
+					entries[k]);
+			std::sort(entries[k].begin(), entries[k].end());
+		});
+
+		Index nonZeros = assembledA.nonZeros();
+		for(const auto &row : entries) {
+			nonZeros += row.size();
+		}
+
+		Matrix A(assembledA.rows(), assembledA.cols());
+		A.reserve(nonZeros);
+
+		std::size_t k = 0;
+		for(Index i = 0; i < assembledA.outerSize(); ++i) {
+			A.startVec(i);
+
+			if(k < rows.size() && rows[k] == i) {
+				for(const Entry &entry : entries[k]) {
+					A.insertBack(i, entry.first) =
+							entry.second;
+				}
+				assembledB(i) = values[k];
+				++k;
+				continue;
+			}
+
+			for(Matrix::InnerIterator it(assembledA, i); it; ++it) {
+				A.insertBack(i, it.index()) = it.value();
+			}
+		}
+		A.finalize();
+
+		assembledA.swap(A);
+	}
+
+	/**
+	 * Finds the optimal control at each node in [first, last), starting
+	 * from a neighbourhood of the optimal control found previously.
+	 * @return The number of nodes at which the whole control domain had to
+	 *         be searched.
+	 */
+	std::size_t optimizeWarm(Vector (&optimal)[ControlDimension],
+			const std::vector<typename Rowwise::Control> &controls,
+			Real time, const Vector &x, Index first, Index last) {
+		std::vector<Index> nodes;
+		std::vector<typename Rowwise::Control> local;
+		std::vector<Real> residuals;
+
+		// Best control among the given ones at the given row
+		auto search = [&] (Index row, const std::vector<Index> &nodes) {
+			local.clear();
+			for(Index k : nodes) {
+				local.push_back(controls[k]);
+			}
+			residuals.resize(local.size());
+			rowwise->residuals(time, x, local, row, row + 1,
+					residuals.data());
+
+			Real best = std::numeric_limits<Real>::infinity();
+			if(Max) {
+				best *= -1;
+			}
+
+			Index c = -1;
+			for(Index l = 0; l < (Index) nodes.size(); ++l) {
+				if( Order()(residuals[l], best) ) {
+					best = residuals[l];
+					c = l;
+				}
+			}
+			return c < 0 ? -1 : nodes[c];
+		};
+
+		std::size_t count = 0;
+		for(Index i = first; i < last; ++i) {
+			const Index centre = previous[i];
+
+			Index k = -1;
+			if(centre >= 0) {
+				warm->neighbourhood(centre, nodes);
+				k = search(i, nodes);
+			}
+
+			if(k < 0 || !warm->isInterior(centre, k)) {
+				nodes.resize(controls.size());
+				for(Index l = 0; l < (Index) nodes.size(); ++l) {
+					nodes[l] = l;
+				}
+				k = search(i, nodes);
+				++count;
+			}
+
+			if(k >= 0) {
+				for(Index j = 0; j < ControlDimension; ++j) {
+					optimal[j](i) = controls[k][j];
+				}
+			}
+
+			previous[i] = k;
+		}
+
+		return count;
+	}
+
+	/**
+	 * Finds the optimal control at each node by evaluating the residuals
+	 * one row at a time; A and b are only assembled for the optimal
+	 * control.
+	 */
+	void optimizeRowwise(Vector (&optimal)[ControlDimension]) {
+		std::vector<typename Rowwise::Control> controls;
+		for(auto node : *controlDomain) {
+			typename Rowwise::Control control;
+			for(Index j = 0; j < ControlDimension; ++j) {
+				control[j] = node[j];
+			}
+			controls.push_back(control);
+		}
+
+		const Index count = controls.size();
+		const Index size = domain->size();
+		const unsigned chunks = threads == 0 ? hardwareThreads()
+				: threads;
+
+		const Real time = nextTime();
+		const Vector &x = iterand(0);
+
+		if(warm && (Index) previous.size() != size) {
+			previous.assign(size, -1);
+		}
+		std::vector<std::size_t> counts(chunks, 0);
+
+		parallelFor(0, chunks, chunks, [&] (Index k) {
+			const Index first = (Index) (
+					(std::intmax_t) size * k / chunks );
+			const Index last = (Index) (
+					(std::intmax_t) size * (k + 1) / chunks );
+
+			if(optimizer) {
+				optimizeNodes(optimal, time, x, first, last);
+				return;
+			}
+
+			if(warm) {
+				counts[k] = optimizeWarm(optimal, controls,
+						time, x, first, last);
+				return;
+			}
+
+			std::vector<Real> residuals((last - first) * count);
+			rowwise->residuals(time, x, controls, first, last,
+					residuals.data());
+
+			const Real *candidate = residuals.data();
+			for(Index i = first; i < last; ++i) {
+				// Same comparisons as below: the first control
+				// attaining the optimum wins
+				Real best = std::numeric_limits<Real>::infinity();
+				if(Max) {
+					best *= -1;
+				}
+
+				Index c = -1;
+				for(Index l = 0; l < count; ++l) {
+					if( Order()(candidate[l], best) ) {
+						best = candidate[l];
+						c = l;
+					}
+				}
+
+				if(c >= 0) {
+					for(Index j = 0; j < ControlDimension;
+							++j) {
+						optimal[j](i) = controls[c][j];
+					}
+				}
+
+				candidate += count;
+			}
+		});
+
+		if(warm) {
+			searches += size;
+			for(std::size_t count : counts) {
+				fallbacks += count;
+			}
+		}
+	}
+
+	/**
+	 * Finds the optimal control at each node in [first, last) using the
+	 * control optimizer.
+	 */
+	void optimizeNodes(Vector (&optimal)[ControlDimension], Real time,
+			const Vector &x, Index first, Index last) const {
+		std::vector<typename Rowwise::Control> single(1);
+
+		for(Index i = first; i < last; ++i) {
+			auto objective = [&] (const typename Rowwise::Control
+					&control) {
+				single[0] = control;
+
+				Real residual;
+				rowwise->residuals(time, x, single, i, i + 1,
+						&residual);
+
+				// The optimizer minimizes
+				return Max ? -residual : residual;
+			};
+
+			typename Rowwise::Control control;
+			const Real best = optimizer->minimize(time, i, x,
+					objective, control);
+
+			if(best < std::numeric_limits<Real>::infinity()) {
+				for(Index j = 0; j < ControlDimension; ++j) {
+					optimal[j](i) = control[j];
+				}
+			}
+		}
+	}
 
 	virtual void onIterationStart() {
 		NaryMethodNonConst<void, ControlledLinearSystemBase,
@@ -65,6 +382,21 @@ class PolicyIteration : public IterationNode {
 			optimal[i] = domain->vector();
 		}
 
+		if(rowwise) {
+			optimizeRowwise(optimal);
+			for(Index i = 0; i < ControlDimension; ++i) {
+				current[i] = optimal[i];
+			}
+
+			// A is the same as on the previous iteration if no
+			// control changed
+			unchanged = assembled && nextTime() == assembledTime
+					&& changedRows().empty();
+			packMoveAndCall<ControlDimension>(*system, setInputs,
+					optimal);
+			return;
+		}
+
 		// Best configuration; initialize to plus-minus infinity
 		//#ifdef NDEBUG
 		//Vector best = domain->ones() * SignedInfinity<!Max>::value;
@@ -104,22 +436,118 @@ class PolicyIteration : public IterationNode {
 		packMoveAndCall<ControlDimension>(*system, setInputs, optimal);
 	}
 
+	virtual void clear() {
+		assembled = false;
+		unchanged = false;
+	}
+
 public:
 
+	/**
+	 * Constructor. If the system is a RowwiseControlledLinearSystem, the
+	 * optimal control is found row by row, and A and b are only
+	 * reassembled at the rows whose control changed from one iteration to
+	 * the next.
+	 * @param domain The spatial domain.
+	 * @param controlDomain The (discrete) set of controls to search.
+	 * @param system The controlled linear system.
+	 */
 	template <typename D, typename C>
 	PolicyIteration(D &domain, C &controlDomain,
 			ControlledLinearSystemBase &system) noexcept
 			: domain(&domain), controlDomain(&controlDomain),
-			system(&system) {
+			system(&system),
+			rowwise(dynamic_cast<Rowwise *>(&system)),
+			optimizer(nullptr), threads(1), searches(0),
+			fallbacks(0), assembledTime(0.), assembled(false),
+			unchanged(false) {
+	}
+
+	/**
+	 * Searches for the optimal control at each node in a neighbourhood of
+	 * the one found on the previous iteration first, falling back to the
+	 * whole control domain only if the best control lies on the boundary
+	 * of the neighbourhood. This requires the system to be a
+	 * RowwiseControlledLinearSystem and the control domain to be a
+	 * RectilinearGrid.
+	 * @param radius The size of the neighbourhood (in ticks along each
+	 *               axis).
+	 * @see QuantPDE::NeighbourhoodSearch
+	 */
+	void setWarmStart(int radius = 1) {
+		assert(rowwise);
+
+		const RectilinearGrid<ControlDimension> *grid = dynamic_cast<
+				const RectilinearGrid<ControlDimension> *>(
+				controlDomain);
+		assert(grid);
+
+		warm = std::unique_ptr<NeighbourhoodSearch<ControlDimension>>(
+			new NeighbourhoodSearch<ControlDimension>(*grid, radius)
+		);
+		previous.clear();
+	}
+
+	/**
+	 * @return The number of (warm-started) searches for an optimal control
+	 *         performed so far.
+	 */
+	std::size_t warmStartSearches() const {
+		return searches;
+	}
+
+	/**
+	 * @return The number of warm-started searches that had to fall back to
+	 *         searching the whole control domain.
+	 */
+	std::size_t warmStartFallbacks() const {
+		return fallbacks;
+	}
+
+	/**
+	 * Uses an optimizer to find the optimal control at each node instead of
+	 * searching the control domain exhaustively. This requires the system
+	 * to be a RowwiseControlledLinearSystem.
+	 * @param optimizer The optimizer (must outlive this object).
+	 */
+	void setOptimizer(const ControlOptimizer<ControlDimension> &optimizer) {
+		assert(rowwise);
+		this->optimizer = &optimizer;
+	}
+
+	/**
+	 * Sets the number of threads used to search for the optimal control
+	 * (only used if the system supports row-wise residuals).
+	 * @param threads The number of threads (0 to use all hardware
+	 *                threads).
+	 */
+	void setThreads(unsigned threads) {
+		this->threads = threads;
+	}
+
+	virtual bool isATheSame() const {
+		return unchanged;
 	}
 
 	virtual Matrix A(Real t) {
 		assert( t == nextTime() );
+
+		if(rowwise) {
+			assemble();
+			return assembledA;
+		}
+
 		return system->A(t);
 	}
 
 	virtual Vector b(Real t) {
 		assert( t == nextTime() );
+
+		if(rowwise) {
+			assemble();
+			return assembledB;
+		}
+
 		return system->b(t);
 	}
 
@@ -69,7 +69,7 @@ class Rannacher : public IterationNode {
 		return (
 			this->domain.identity()
 			- A * h0 / 2.
-		) * v0 + ( op.b(t1) + op.b(t0) ) / 2.;
+		) * v0 + ( op.b(t1) + op.b(t0) ) * h0 / 2.;
 	}
 
 	void _onIterationEnd1() {
@@ -0,0 +1,187 @@
+#ifndef QUANT_PDE_CORE_SPARSE_GRID_HPP
+#define QUANT_PDE_CORE_SPARSE_GRID_HPP
+
+#include <array>   // std::array
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <memory>  // std::unique_ptr
+#include <tuple>   // std::get, std::make_tuple, std::tuple
+#include <utility> // std::forward, std::move
+#include <vector>  // std::vector
+
+namespace QuantPDE {
+
+/**
+ * A linear combination \f$c_1 f_1 + \cdots + c_n f_n\f$ of interpolants.
+ * @see QuantPDE::combinationTechnique
+ */
+template <Index Dimension>
+class LinearCombination : public Interpolant<Dimension> {
+
+	typedef std::unique_ptr<Interpolant<Dimension>> I;
+	typedef std::tuple<Real, InterpolantWrapper<Dimension>> Term;
+
+	std::vector<Term> terms;
+
+public:
+
+	/**
+	 * Constructor.
+	 */
+	LinearCombination() noexcept {
+	}
+
+	/**
+	 * Copy constructor.
+	 */
+	LinearCombination(const LinearCombination &that) noexcept
+			: terms(that.terms) {
+	}
+
+	// Immutable once built, as with the other interpolants
+	LinearCombination(LinearCombination &&that) = delete;
+	LinearCombination &operator=(const LinearCombination &) = delete;
+
+	/**
+	 * Adds a term to the combination.
+	 * @param coefficient The coefficient.
+	 * @param interpolant The interpolant.
+	 */
+	void add(Real coefficient, InterpolantWrapper<Dimension> interpolant) {
+		terms.push_back( std::make_tuple(coefficient,
+				std::move(interpolant)) );
+	}
+
+	virtual Real interpolate(const std::array<Real, Dimension> &coordinates)
+			const {
+		Real interpolated = 0.;
+		for(const Term &term : terms) {
+			interpolated += std::get<0>(term)
+					* std::get<1>(term).interpolate(
+					coordinates);
+		}
+		return interpolated;
+	}
+
+	virtual void interpolate(const Points<Dimension> &points,
+			Vector &values) const {
+		values = Vector::Zero(points.rows());
+
+		Vector term;
+		for(const Term &t : terms) {
+			std::get<1>(t).interpolate(points, term);
+			values += std::get<0>(t) * term;
+		}
+	}
+
+	virtual I clone() const {
+		return I(new LinearCombination(*this));
+	}
+
+};
+
+typedef LinearCombination<1> LinearCombination1;
+typedef LinearCombination<2> LinearCombination2;
+typedef LinearCombination<3> LinearCombination3;
+
+/**
+ * Approximates the solution on the full grid refined the given number of times
+ * by the sparse-grid combination technique: the problem is solved
+ * independently on each of the anisotropic grids whose axes are refined
+ * \f$l_1,\ldots,l_d\f$ times with \f$l_1+\cdots+l_d=n-q\f$, where
+ * \f$q=0,\ldots,d-1\f$, and the solutions are combined as
+ * \f[
+ * u_n^c = \sum_{q=0}^{d-1} \left(-1\right)^q \binom{d-1}{q}
+ * 	\sum_{l_1+\cdots+l_d=n-q} u_{l_1,\ldots,l_d}.
+ * \f]
+ *
+ * The largest grid has about as many nodes as the full grid refined n times
+ * along a single axis, and there are \f$O(n^{d-1})\f$ of them. For a solution
+ * with bounded mixed derivatives, the error is that of the full grid up to a
+ * factor of \f$O(n^{d-1})\f$.
+ *
+ * Example:
+ * \code{.cpp}
+ * RectilinearGrid3 grid(...);
+ * auto u = combinationTechnique(grid, 5, [&] (const RectilinearGrid3 &grid) {
+ * 	// Solve the problem on this grid
+ * 	return iteration.solve(grid, payoff, discretization, solver);
+ * }, 0);
+ * \endcode
+ * @param grid The grid to refine.
+ * @param level The level of refinement n.
+ * @param solve Returns the solution (an InterpolantWrapper) on a grid. It is
+ *              called concurrently, and so must be safe to do so if threads
+ *              is not 1.
+ * @param threads The number of threads (0 to use hardwareThreads()).
+ * @return The combined solution.
+ * @see QuantPDE::RectilinearGrid::refined
+ */
+template <Index Dimension, typename F>
+InterpolantWrapper<Dimension> combinationTechnique(
+	const RectilinearGrid<Dimension> &grid,
+	int level,
+	F &&solve,
+	unsigned threads = 1
+) {
+	assert(level >= 0);
+
+	typedef std::array<int, Dimension> Levels;
+
+	// Each grid and its coefficient
+	std::vector<Levels> levels;
+	std::vector<Real> coefficients;
+
+	Real binomial = 1.;
+	for(int q = 0; q < Dimension && q <= level; ++q) {
+		const int sum = level - q;
+		const Real coefficient = (q % 2 ? -1. : 1.) * binomial;
+		binomial = binomial * (Dimension - 1 - q) / (q + 1);
+
+		// Each l with l_1 + ... + l_d = sum
+		Levels l;
+		l.fill(0);
+		l[Dimension - 1] = sum;
+		while(true) {
+			levels.push_back(l);
+			coefficients.push_back(coefficient);
+
+			// Next composition of sum, in lexicographic order of
+			// the first d - 1 parts
+			Index k = Dimension - 2;
+			while(k >= 0 && l[Dimension - 1] == 0) {
+				l[Dimension - 1] += l[k];
+				l[k] = 0;
+				--k;
+			}
+			if(k < 0) {
+				break;
+			}
+			++l[k];
+			--l[Dimension - 1];
+		}
+	}
+
+	std::vector<std::unique_ptr<InterpolantWrapper<Dimension>>> solutions(
+			levels.size());
+	parallelFor(0, levels.size(), threads, [&] (Index k) {
+		solutions[k] = std::unique_ptr<InterpolantWrapper<Dimension>>(
+			new InterpolantWrapper<Dimension>(
+				solve( grid.refined(levels[k]) )
+			)
+		);
+	});
+
+	LinearCombination<Dimension> *combination =
+			new LinearCombination<Dimension>;
+	for(std::size_t k = 0; k < levels.size(); ++k) {
+		combination->add(coefficients[k], std::move(*solutions[k]));
+	}
+
+	return InterpolantWrapper<Dimension>(
+			std::unique_ptr<Interpolant<Dimension>>(combination));
+}
+
+} // QuantPDE
+
+#endif
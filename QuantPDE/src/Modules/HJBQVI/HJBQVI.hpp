@@ -3,17 +3,20 @@
 
 #include <algorithm>        // std::max
 #include <array>            // std::array
+#include <cassert>          // assert
 #include <chrono>           // std::chrono
 #include <cmath>            // std::nan
+#include <cstddef>          // std::size_t
 #include <functional>       // std::function
 #include <iostream>         // std::ostream, std::cout
 #include <iomanip>          // std::setw
 #include <initializer_list> // std::initializer_list
 #include <limits>           // std::numeric_limits
-#include <memory>           // std::forward, std::unique_ptr
+#include <memory>           // std::forward, std::shared_ptr, std::unique_ptr
 #include <numeric>          // std::accumulate
 #include <string>           // std::string
 #include <tuple>            // std::make_tuple
+#include <utility>          // std::make_pair, std::pair
 #include <vector>           // std::vector
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -78,6 +81,13 @@ struct Result {
 
 	const Real execution_time_seconds;
 
+	// Fraction of warm-started control searches that searched every control
+	const Real warm_start_fallback_ratio;
+
+	// Iterands converged to (if recorded), used to warm-start the next
+	// level of refinement
+	std::shared_ptr<const IterandHistory<Dimension>> history;
+
 	Result(
 		const RectilinearGrid<Dimension> &spatial_grid,
 		const RectilinearGrid<StochasticControlDimension>
@@ -96,7 +106,8 @@ struct Result {
 		Real mean_inner_iterations,
 		Real mean_solver_iterations,
 
-		Real execution_time_seconds
+		Real execution_time_seconds,
+		Real warm_start_fallback_ratio = std::nan("")
 	) noexcept :
 		spatial_grid(spatial_grid),
 		stochastic_control_grid(stochastic_control_grid),
@@ -112,7 +123,8 @@ struct Result {
 		mean_inner_iterations(mean_inner_iterations),
 		mean_solver_iterations(mean_solver_iterations),
 
-		execution_time_seconds(execution_time_seconds)
+		execution_time_seconds(execution_time_seconds),
+		warm_start_fallback_ratio(warm_start_fallback_ratio)
 	{
 		for(Index i = 0; i < StochasticControlDimension; ++i) {
 			this->stochastic_control_vector[i] =
@@ -132,13 +144,130 @@ private:
 struct ControlledOperator final : public RawControlledLinearSystem<
 	Dimension,
 	StochasticControlDimension
-> {
+>, public RowwiseControlledLinearSystem<StochasticControlDimension> {
+
+	typedef RowwiseControlledLinearSystem<StochasticControlDimension>
+			Rowwise;
 
 	const HJBQVI hjbqvi;
 	RectilinearGrid<Dimension> refined_spatial_grid;
 
 	int offsets[Dimension];
 
+	/**
+	 * Same as A(time) restricted to a single row. A(time) is assembled
+	 * from this (and b(time) from flow), so that it agrees with row().
+	 * @param i The multi-index of the node.
+	 * @param args The time, the coordinates of the node, and the control.
+	 * @param row The row.
+	 * @param entries The nonzero entries of the row are appended to this.
+	 */
+	void assembleRow(const int (&i)[Dimension],
+			Real (&args)[1+Dimension+StochasticControlDimension],
+			Index row, std::vector<typename Rowwise::Entry> &entries) {
+		typedef typename Rowwise::Entry Entry;
+
+		Real total = 0.;
+
+		for(int d = 0; d < Dimension; ++d) {
+			// Boundaries
+			const bool left = (i[d] == 0);
+			if(left || i[d] == refined_spatial_grid[d].size() - 1) {
+				const boundary_routine &routine = left
+						? hjbqvi.lboundary[d]
+						: hjbqvi.rboundary[d];
+				if(routine != nullptr) {
+					total += routine(
+						hjbqvi,
+						refined_spatial_grid,
+						d, // index
+						args, i, offsets,
+						row, entries
+					);
+				}
+				continue;
+			}
+
+			const Axis &x = refined_spatial_grid[d];
+
+			const Real
+				dxb = x[ i[d]     ] - x[ i[d] - 1 ],
+				dxc = x[ i[d] + 1 ] - x[ i[d] - 1 ],
+				dxf = x[ i[d] + 1 ] - x[ i[d]     ]
+			;
+
+			// Get volatility
+			const Real v = packAndCall<1+Dimension>(
+				hjbqvi.volatility[d],
+				args
+			);
+
+			// Get drifts
+			Real mu = 0.;
+			if(!hjbqvi.semi_lagrangian()) {
+				mu += packAndCall<
+					1
+					+Dimension
+					+StochasticControlDimension
+				>(
+					hjbqvi.controlled_drift[d],
+					args
+				);
+			}
+
+			const Real vv = v * v;
+
+			const Real alpha_common = vv / dxb / dxc;
+			const Real  beta_common = vv / dxf / dxc;
+
+			// Central
+			Real alpha = alpha_common - mu / dxc;
+			Real  beta =  beta_common + mu / dxc;
+			if(alpha < 0.) {
+				alpha = alpha_common;
+				 beta =  beta_common + mu / dxf;
+			} else if(beta < 0.) {
+				alpha = alpha_common - mu / dxb;
+				 beta =  beta_common;
+			}
+
+			entries.push_back(Entry(row - offsets[d], -alpha));
+			entries.push_back(Entry(row + offsets[d], - beta));
+
+			total += alpha + beta;
+		}
+
+		const Real rho = packAndCall<1+Dimension>(
+			hjbqvi.discount,
+			args
+		);
+
+		entries.push_back(Entry(row, total + rho));
+	}
+
+	/**
+	 * @param args The time, the coordinates of a node, and the control.
+	 * @return The entry of b(time) at the row of the node.
+	 */
+	Real flow(const Real (&args)[1+Dimension+StochasticControlDimension]) {
+		// Get flows
+		const Real controlled = packAndCall<
+			1
+			+Dimension
+			+StochasticControlDimension
+		>(
+			hjbqvi.controlled_continuous_flow,
+			args
+		);
+		/*Real uncontrolled = packAndCall<1+Dimension>(
+			hjbqvi.uncontrolled_continuous_flow,
+			args
+		);*/
+
+		return hjbqvi.semi_lagrangian() ? 0 : controlled;
+				/*+ uncontrolled;*/
+	}
+
 	template <typename H, typename R>
 	ControlledOperator(
 		H &hjbqvi,
@@ -148,10 +277,8 @@ struct ControlledOperator final : public RawControlledLinearSystem<
 		refined_spatial_grid(refined_spatial_grid)
 	{
 		// Space between ticks
-		offsets[0] = 1;
-		for(int d = 1; d < Dimension; ++d) {
-			offsets[d] = offsets[d-1]
-					* refined_spatial_grid[d-1].size();
+		for(int d = 0; d < Dimension; ++d) {
+			offsets[d] = refined_spatial_grid.stride(d);
 		}
 	}
 
@@ -175,111 +302,34 @@ struct ControlledOperator final : public RawControlledLinearSystem<
 					: this->control(d);
 		}
 
-		// Iterate through points on grid
-		int i[Dimension];
+		// Iterate through points on grid; the rows are the same as those
+		// given by row(...)
+		std::vector<typename Rowwise::Entry> entries;
+		entries.reserve(1 + 2 * Dimension);
+
 		Real args[1+Dimension+StochasticControlDimension];
-		for(int row = 0; row < refined_spatial_grid.size(); ++row) {
-			Real total = 0.;
+		for(
+			auto it = refined_spatial_grid.rows();
+			*it < refined_spatial_grid.size();
+			++it
+		) {
+			const int row = *it;
+			const int (&i)[Dimension] = it.indices();
 
 			// Get coordinates of point
 			args[0] = time; // Time
 			for(int d = 0; d < Dimension; ++d) {
-				i[d] = (row / offsets[d]) %
-						refined_spatial_grid[d].size();
 				args[1+d] = refined_spatial_grid[d][i[d]];
 			}
 			for(int d = 0; d < StochasticControlDimension; ++d) {
 				args[1+Dimension+d] = q[d](row); // Control
 			}
 
-			for(int d = 0; d < Dimension; ++d) {
-				// Left boundary
-				if(i[d] == 0) {
-					if(hjbqvi.lboundary[d] != nullptr) {
-						total += hjbqvi.lboundary[d](
-							hjbqvi,
-							refined_spatial_grid,
-							d, // index
-							args, i, offsets,
-							A, row
-						);
-					}
-					continue;
-				}
-
-				// Right boundary
-				if(i[d] == refined_spatial_grid[d].size() - 1) {
-					if(hjbqvi.rboundary[d] != nullptr) {
-						total += hjbqvi.rboundary[d](
-							hjbqvi,
-							refined_spatial_grid,
-							d, // index
-							args, i, offsets,
-							A, row
-						);
-					}
-					continue;
-				}
-
-				const Axis &x = refined_spatial_grid[d];
-
-				const Real
-					dxb = x[ i[d]     ] - x[ i[d] - 1 ],
-					dxc = x[ i[d] + 1 ] - x[ i[d] - 1 ],
-					dxf = x[ i[d] + 1 ] - x[ i[d]     ]
-				;
-
-				// Get volatility
-				const Real v = packAndCall<1+Dimension>(
-					hjbqvi.volatility[d],
-					args
-				);
-
-				// Get drifts
-				/*Real mu = packAndCall<1+Dimension>(
-					hjbqvi.uncontrolled_drift[d],
-					args
-				);*/
-				Real mu = 0.;
-				if(!hjbqvi.semi_lagrangian()) {
-					mu += packAndCall<
-						1
-						+Dimension
-						+StochasticControlDimension
-					>(
-						hjbqvi.controlled_drift[d],
-						args
-					);
-				}
-
-				const Real vv = v * v;
-
-				const Real alpha_common = vv / dxb / dxc;
-				const Real  beta_common = vv / dxf / dxc;
-
-				// Central
-				Real alpha = alpha_common - mu / dxc;
-				Real  beta =  beta_common + mu / dxc;
-				if(alpha < 0.) {
-					alpha = alpha_common;
-					 beta =  beta_common + mu / dxf;
-				} else if(beta < 0.) {
-					alpha = alpha_common - mu / dxb;
-					 beta =  beta_common;
-				}
-
-				A.insert(row, row - offsets[d]) = -alpha;
-				A.insert(row, row + offsets[d]) = - beta;
-
-				total += alpha + beta;
+			entries.clear();
+			assembleRow(i, args, row, entries);
+			for(const auto &entry : entries) {
+				A.insert(row, entry.first) = entry.second;
 			}
-
-			const Real rho = packAndCall<1+Dimension>(
-				hjbqvi.discount,
-				args
-			);
-
-			A.insert(row, row) = total + rho;
 		}
 
 		A.makeCompressed();
@@ -298,37 +348,24 @@ struct ControlledOperator final : public RawControlledLinearSystem<
 		}
 
 		// Iterate through points on grid
-		int i[Dimension];
 		Real args[1+Dimension+StochasticControlDimension];
-		for(int row = 0; row < refined_spatial_grid.size(); ++row) {
+		for(
+			auto it = refined_spatial_grid.rows();
+			*it < refined_spatial_grid.size();
+			++it
+		) {
+			const int row = *it;
 
 			// Get coordinates of point
 			args[0] = time; // Time
 			for(int d = 0; d < Dimension; ++d) {
-				i[d] = (row / offsets[d]) %
-						refined_spatial_grid[d].size();
-				args[1+d] = refined_spatial_grid[d][i[d]];
+				args[1+d] = refined_spatial_grid[d][it[d]];
 			}
 			for(int d = 0; d < StochasticControlDimension; ++d) {
 				args[1+Dimension+d] = q[d](row); // Control
 			}
 
-			// Get flows
-			Real controlled = packAndCall<
-				1
-				+Dimension
-				+StochasticControlDimension
-			>(
-				hjbqvi.controlled_continuous_flow,
-				args
-			);
-			/*Real uncontrolled = packAndCall<1+Dimension>(
-				hjbqvi.uncontrolled_continuous_flow,
-				args
-			);*/
-
-			b(row) = (hjbqvi.semi_lagrangian() ? 0 : controlled);
-					/*+ uncontrolled;*/
+			b(row) = flow(args);
 		}
 
 		return b;
@@ -340,6 +377,250 @@ struct ControlledOperator final : public RawControlledLinearSystem<
 				&& hjbqvi.time_independent_coefficients;
 	}
 
+	virtual Real row(Real time,
+			const typename Rowwise::Control &control, Index row,
+			std::vector<typename Rowwise::Entry> &entries) {
+		const auto it = refined_spatial_grid.rows(row);
+		const int (&i)[Dimension] = it.indices();
+		Real args[1+Dimension+StochasticControlDimension];
+
+		// Get coordinates of point
+		args[0] = time; // Time
+		for(int d = 0; d < Dimension; ++d) {
+			args[1+d] = refined_spatial_grid[d][i[d]];
+		}
+		for(int d = 0; d < StochasticControlDimension; ++d) {
+			args[1+Dimension+d] = hjbqvi.semi_lagrangian()
+					? 0. : control[d]; // Control
+		}
+
+		assembleRow(i, args, row, entries);
+		return flow(args);
+	}
+
+	virtual void residuals(Real time, const Vector &u,
+			const std::vector<typename Rowwise::Control> &controls,
+			Index begin, Index end, Real *residuals) {
+		std::vector<typename Rowwise::Entry> entries;
+		entries.reserve(1 + 2 * Dimension);
+
+		Real args[1+Dimension+StochasticControlDimension];
+		for(auto it = refined_spatial_grid.rows(begin); *it < end;
+				++it) {
+			const Index row = *it;
+			const int (&i)[Dimension] = it.indices();
+
+			// Get coordinates of point
+			args[0] = time; // Time
+			for(int d = 0; d < Dimension; ++d) {
+				args[1+d] = refined_spatial_grid[d][i[d]];
+			}
+
+			for(const auto &control : controls) {
+				for(
+					int d = 0;
+					d < StochasticControlDimension;
+					++d
+				) {
+					args[1+Dimension+d] =
+						hjbqvi.semi_lagrangian()
+						? 0. : control[d]; // Control
+				}
+
+				entries.clear();
+				assembleRow(i, args, row, entries);
+				const Real b = flow(args);
+
+				*(residuals++) = Rowwise::rowProduct(
+						entries.data(), entries.size(),
+						u) - b;
+			}
+		}
+	}
+
+};
+
+/**
+ * The departure points of the semi-Lagrangian scheme, located on the spatial
+ * grid once and for all. This is only valid if the coefficients are
+ * time-independent, in which case the departure points (and hence the
+ * interpolation weights) do not change from one timestep to the next.
+ *
+ * For each row, the (stochastic) controls whose departure points are not
+ * dropped are stored contiguously, along with the nodes and weights of the
+ * linear interpolant at the departure point and the flow over a timestep.
+ */
+struct SemiLagrangianStencil final {
+
+	typedef IntegerPower<2, Dimension> TwoToTheDimension;
+
+	std::vector<Index> offsets;  // Row -> first entry
+	std::vector<Index> controls; // Entry -> control node
+	std::vector<Index> nodes;    // Entry -> 2^Dimension spatial nodes
+	std::vector<Real> factors;   // Entry -> 2^Dimension weights
+	std::vector<Real> flows;     // Entry -> flow * dt
+
+	// Control node -> coordinates
+	std::vector<std::array<Real, StochasticControlDimension>> coordinates;
+
+	SemiLagrangianStencil(
+		const HJBQVI &hjbqvi,
+		const RectilinearGrid<Dimension> &refined_spatial_grid,
+		const RectilinearGrid<StochasticControlDimension>
+				&refined_stochastic_control_grid,
+		Real time,
+		Real dt
+	) {
+		for(auto node : refined_stochastic_control_grid) {
+			std::array<Real, StochasticControlDimension> c;
+			for(int d = 0; d < StochasticControlDimension; ++d) {
+				c[d] = node[d];
+			}
+			coordinates.push_back(c);
+		}
+
+		int strides[Dimension];
+		strides[0] = 1;
+		for(int d = 1; d < Dimension; ++d) {
+			strides[d] = strides[d-1]
+					* refined_spatial_grid[d-1].size();
+		}
+
+		const Index rows = refined_spatial_grid.size();
+		offsets.reserve(rows + 1);
+		offsets.push_back(0);
+
+		Real args[1+Dimension+StochasticControlDimension];
+		args[0] = time;
+		for(Index row = 0; row < rows; ++row) {
+			for(int d = 0; d < Dimension; ++d) {
+				const int i = (row / strides[d]) %
+						refined_spatial_grid[d].size();
+				args[1+d] = refined_spatial_grid[d][i];
+			}
+
+			for(Index k = 0; k < (Index) coordinates.size(); ++k) {
+				for(
+					int d = 0;
+					d < StochasticControlDimension;
+					++d
+				) {
+					args[1+Dimension+d] = coordinates[k][d];
+				}
+
+				// Same as in ExplicitEvent
+				bool skip = false;
+				std::array<Real, Dimension> new_state;
+				for(int d = 0; d < Dimension; ++d) {
+					const Real m = packAndCall<
+						1
+						+Dimension
+						+StochasticControlDimension
+					>(
+						hjbqvi.controlled_drift[d],
+						args
+					);
+					new_state[d] = args[1+d] + m * dt;
+
+					const Axis &axis =
+							refined_spatial_grid[d];
+					if( hjbqvi.drop_semi_lagrangian_off_grid
+							&& ( new_state[d]
+							< axis[0] ||
+							new_state[d] > axis[
+							axis.size()-1] ) ) {
+						skip = true;
+						break;
+					}
+				}
+				if(skip) { continue; }
+
+				const Real flow = packAndCall<
+					1
+					+Dimension
+					+StochasticControlDimension
+				>(
+					hjbqvi.controlled_continuous_flow,
+					args
+				);
+
+				// Same as in PiecewiseLinear::interpolate
+				auto data = linearInterpolationData<Dimension>(
+					refined_spatial_grid,
+					new_state
+				);
+
+				for(
+					std::intmax_t i = 0;
+					i < TwoToTheDimension::value;
+					++i
+				) {
+					Real factor = 1.;
+					Index index = 0;
+					for(int j = 0; j < Dimension; ++j) {
+						const Index l = std::get<0>(
+								data[j] );
+						const Real w = std::get<1>(
+								data[j] );
+						if(i & (1 << j)) {
+							index += l * strides[j];
+							factor *= w;
+						} else {
+							index += (l + 1)
+								* strides[j];
+							factor *= 1. - w;
+						}
+					}
+					nodes.push_back(index);
+					factors.push_back(factor);
+				}
+
+				controls.push_back(k);
+				flows.push_back(flow * dt);
+			}
+
+			offsets.push_back(controls.size());
+		}
+	}
+
+};
+
+/**
+ * State shared by the events to warm-start the search for the optimal controls
+ * at each node from the ones found at the previous timestep.
+ */
+struct WarmStart final {
+
+	NeighbourhoodSearch<StochasticControlDimension> stochastic;
+	NeighbourhoodSearch<ImpulseControlDimension> impulse;
+
+	// Row -> index of the previous optimal control (-1 if none)
+	std::vector<Index> previous_stochastic, previous_impulse;
+
+	// Row -> whether the last search had to fall back to the whole grid
+	std::vector<char> stochastic_fallbacks, impulse_fallbacks;
+
+	std::size_t searches, fallbacks;
+
+	WarmStart(
+		const RectilinearGrid<Dimension> &refined_spatial_grid,
+		const RectilinearGrid<StochasticControlDimension>
+				&refined_stochastic_control_grid,
+		const RectilinearGrid<ImpulseControlDimension>
+				&refined_impulse_control_grid,
+		int radius
+	) noexcept :
+		stochastic(refined_stochastic_control_grid, radius),
+		impulse(refined_impulse_control_grid, radius),
+		previous_stochastic(refined_spatial_grid.size(), -1),
+		previous_impulse(refined_spatial_grid.size(), -1),
+		stochastic_fallbacks(refined_spatial_grid.size(), 0),
+		impulse_fallbacks(refined_spatial_grid.size(), 0),
+		searches(0),
+		fallbacks(0)
+	{
+	}
+
 };
 
 class ExplicitEvent : public EventBase {
@@ -353,19 +634,103 @@ class ExplicitEvent : public EventBase {
 	Vector (&stochastic_control_vector)[StochasticControlDimension];
 	Vector (&impulse_control_vector)[ImpulseControlDimension];
 	Real time, dt;
-	std::vector<bool> &mask;
+	std::vector<char> &mask;
+	const SemiLagrangianStencil *stencil;
+	WarmStart *warm;
+
+	/**
+	 * Finds the node k maximizing value(k), searching a neighbourhood of
+	 * the previous optimal node first if possible.
+	 * @param size The number of nodes.
+	 * @param neighbourhood Used to warm-start the search (or nullptr).
+	 * @param previous The previous optimal node (or -1).
+	 * @param value The function to maximize.
+	 * @param best On input, negative infinity. On output, the maximum.
+	 * @param fallback On output, true if and only if a warm-started search
+	 *                 had to search every node.
+	 * @return The optimal node, or -1 if no value exceeds best.
+	 */
+	template <Index ControlDimension, typename F>
+	static Index search(
+		Index size,
+		const NeighbourhoodSearch<ControlDimension> *neighbourhood,
+		Index previous,
+		F &value,
+		Real &best,
+		bool &fallback
+	) {
+		Index optimal = -1;
+		auto consider = [&] (Index k) {
+			const Real new_value = value(k);
+			if(new_value > best) {
+				best = new_value;
+				optimal = k;
+			}
+		};
+
+		fallback = false;
+		if(neighbourhood) {
+			if(previous >= 0) {
+				std::vector<Index> nodes;
+				neighbourhood->neighbourhood(previous, nodes);
+				for(Index k : nodes) {
+					consider(k);
+				}
 
-	int offsets[Dimension];
+				if(optimal >= 0 && neighbourhood->isInterior(
+						previous, optimal)) {
+					return optimal;
+				}
+
+				best = -std::numeric_limits<Real>::infinity();
+				optimal = -1;
+			}
+
+			fallback = true;
+		}
+
+		for(Index k = 0; k < size; ++k) {
+			consider(k);
+		}
+
+		return optimal;
+	}
 
 	template <typename V>
 	Vector _doEvent(V &&vector) const {
 
-		mask.clear();
+		// A std::vector<bool> packs bits; writing to distinct entries
+		// from different threads is not safe
+		mask.resize(refined_spatial_grid.size());
 
 		Vector best = refined_spatial_grid.vector();
 
 		PiecewiseLinear<Dimension> u(refined_spatial_grid, vector);
 
+		// Controls by index
+		std::vector<std::array<Real, StochasticControlDimension>>
+				stochastic_controls;
+		for(auto node : refined_stochastic_control_grid) {
+			std::array<Real, StochasticControlDimension> c;
+			for(int d = 0; d < StochasticControlDimension; ++d) {
+				c[d] = node[d];
+			}
+			stochastic_controls.push_back(c);
+		}
+
+		std::vector<std::array<Real, ImpulseControlDimension>>
+				impulse_controls;
+		for(auto node : refined_impulse_control_grid) {
+			std::array<Real, ImpulseControlDimension> c;
+			for(int d = 0; d < ImpulseControlDimension; ++d) {
+				c[d] = node[d];
+			}
+			impulse_controls.push_back(c);
+		}
+
+		// Rows are independent: each writes only to its own entries
+		auto optimize = [&] (Index row) {
+
 		Real args[
 			1
 			+Dimension
@@ -376,8 +741,8 @@ class ExplicitEvent : public EventBase {
 				: ImpulseControlDimension
 			)
 		];
-		int i[Dimension];
-		for(int row = 0; row < refined_spatial_grid.size(); ++row) {
+		const std::array<Index, Dimension> i =
+				refined_spatial_grid.indices(row);
 
 		////////////////////////////////////////////////////////////////
 		// begin row loop
@@ -386,26 +751,29 @@ class ExplicitEvent : public EventBase {
 		// Get coordinates of point
 		args[0] = time; // Time
 		for(int d = 0; d < Dimension; ++d) {
-			i[d] = (row / offsets[d]) %
-					refined_spatial_grid[d].size();
 			args[1+d] = refined_spatial_grid[d][i[d]];
 		}
 
 		Real a = -std::numeric_limits<Real>::infinity();
-		if(hjbqvi.semi_lagrangian()) {
+		if(hjbqvi.semi_lagrangian()
+				&& hjbqvi.stochastic_control_optimizer) {
 
-			// Find optimal control
-			for(auto node : refined_stochastic_control_grid) {
+			typedef ControlOptimizer<StochasticControlDimension>
+					Optimizer;
 
+			// Negative of the value of the control; the optimizer
+			// minimizes
+			auto objective = [&] (const typename Optimizer::Control
+					&control) {
 				for(
 					int d = 0;
 					d < StochasticControlDimension;
 					++d
 				) {
-					args[1+Dimension+d] = node[d];
+					args[1+Dimension+d] = control[d];
 				}
 
-				bool skip = false;
+				// Same as below
 				std::array<Real, Dimension> new_state;
 				for(int d = 0; d < Dimension; ++d) {
 					const Real m = packAndCall<
@@ -425,11 +793,10 @@ class ExplicitEvent : public EventBase {
 							< axis[0] ||
 							new_state[d] > axis[
 							axis.size()-1] ) ) {
-						skip = true;
-						break;
+						return std::numeric_limits<
+							Real>::infinity();
 					}
 				}
-				if(skip) { continue; }
 
 				const Real flow = packAndCall<
 					1
@@ -440,23 +807,149 @@ class ExplicitEvent : public EventBase {
 					args
 				);
 
-				const Real new_value =
-					u.interpolate(new_state)
-					+ flow * dt
-				;
+				return -( u.interpolate(new_state) + flow * dt );
+			};
+
+			typename Optimizer::Control control;
+			const Real value = hjbqvi.stochastic_control_optimizer
+					->minimize(time, row, vector, objective,
+					control);
+
+			if(value < std::numeric_limits<Real>::infinity()) {
+				a = -value;
+				for(
+					int d = 0;
+					d < StochasticControlDimension;
+					++d
+				) {
+					stochastic_control_vector[d](row) =
+							control[d];
+				}
+			}
+
+		} else if(hjbqvi.semi_lagrangian() && stencil) {
+
+			// Departure points are precomputed; find optimal control
+			typedef typename SemiLagrangianStencil::TwoToTheDimension
+					TwoToTheDimension;
+			Index optimal = -1;
+			for(
+				Index e = stencil->offsets[row];
+				e < stencil->offsets[row+1];
+				++e
+			) {
+				const Index *nodes = stencil->nodes.data()
+						+ e * TwoToTheDimension::value;
+				const Real *factors = stencil->factors.data()
+						+ e * TwoToTheDimension::value;
+
+				Real interpolated = 0.;
+				for(
+					std::intmax_t i = 0;
+					i < TwoToTheDimension::value;
+					++i
+				) {
+					if(factors[i] > QuantPDE::epsilon) {
+						interpolated += factors[i]
+							* vector(nodes[i]);
+					}
+				}
+
+				const Real new_value = interpolated
+						+ stencil->flows[e];
 
 				if(new_value > a) {
 					a = new_value;
-					for(
-						int d = 0;
-						d < StochasticControlDimension;
-						++d
-					) {
-						stochastic_control_vector[d](
-								row) = args[
-								1+Dimension+d];
+					optimal = stencil->controls[e];
+				}
+			}
+
+			if(optimal >= 0) {
+				for(
+					int d = 0;
+					d < StochasticControlDimension;
+					++d
+				) {
+					stochastic_control_vector[d](row) =
+						stencil->coordinates[optimal][d]
+					;
+				}
+			}
+
+		} else if(hjbqvi.semi_lagrangian()) {
+
+			// Value of the k-th control
+			auto value = [&] (Index k) {
+				for(
+					int d = 0;
+					d < StochasticControlDimension;
+					++d
+				) {
+					args[1+Dimension+d] =
+						stochastic_controls[k][d];
+				}
+
+				std::array<Real, Dimension> new_state;
+				for(int d = 0; d < Dimension; ++d) {
+					const Real m = packAndCall<
+						1
+						+Dimension
+						+StochasticControlDimension
+					>(
+						hjbqvi.controlled_drift[d],
+						args
+					);
+					new_state[d] = args[1+d] + m * dt;
+
+					const Axis &axis =
+							refined_spatial_grid[d];
+					if( hjbqvi.drop_semi_lagrangian_off_grid
+							&& ( new_state[d]
+							< axis[0] ||
+							new_state[d] > axis[
+							axis.size()-1] ) ) {
+						return -std::numeric_limits<
+							Real>::infinity();
 					}
 				}
+
+				const Real flow = packAndCall<
+					1
+					+Dimension
+					+StochasticControlDimension
+				>(
+					hjbqvi.controlled_continuous_flow,
+					args
+				);
+
+				return u.interpolate(new_state) + flow * dt;
+			};
+
+			// Find optimal control
+			bool fallback;
+			const Index optimal = search(
+				stochastic_controls.size(),
+				warm ? &warm->stochastic : nullptr,
+				warm ? warm->previous_stochastic[row] : -1,
+				value,
+				a,
+				fallback
+			);
+
+			if(optimal >= 0) {
+				for(
+					int d = 0;
+					d < StochasticControlDimension;
+					++d
+				) {
+					stochastic_control_vector[d](row) =
+						stochastic_controls[optimal][d];
+				}
+			}
+
+			if(warm) {
+				warm->previous_stochastic[row] = optimal;
+				warm->stochastic_fallbacks[row] = fallback;
 			}
 
 		} else {
@@ -467,15 +960,15 @@ class ExplicitEvent : public EventBase {
 		Real b = -std::numeric_limits<Real>::infinity();
 		if(hjbqvi.explicit_impulse()) {
 
-			// Find optimal control
-			for(auto node : refined_impulse_control_grid) {
-
+			// Value of the k-th control
+			auto value = [&] (Index k) {
 				for(
 					int d = 0;
 					d < ImpulseControlDimension;
 					++d
 				) {
-					args[1+Dimension+d] = node[d];
+					args[1+Dimension+d] =
+						impulse_controls[k][d];
 				}
 
 				std::array<Real, Dimension> new_state;
@@ -499,32 +992,43 @@ class ExplicitEvent : public EventBase {
 					args
 				);
 
-				const Real new_value =
-					u.interpolate(new_state)
-					+ flow
-				;
+				return u.interpolate(new_state) + flow;
+			};
 
-				if(new_value > b) {
-					b = new_value;
-					for(
-						int d = 0;
-						d < ImpulseControlDimension;
-						++d
-					) {
-						impulse_control_vector[d](row) =
-							args[1+Dimension+d]
-						;
-					}
+			// Find optimal control
+			bool fallback;
+			const Index optimal = search(
+				impulse_controls.size(),
+				warm ? &warm->impulse : nullptr,
+				warm ? warm->previous_impulse[row] : -1,
+				value,
+				b,
+				fallback
+			);
+
+			if(optimal >= 0) {
+				for(
+					int d = 0;
+					d < ImpulseControlDimension;
+					++d
+				) {
+					impulse_control_vector[d](row) =
+						impulse_controls[optimal][d];
 				}
 			}
 
+			if(warm) {
+				warm->previous_impulse[row] = optimal;
+				warm->impulse_fallbacks[row] = fallback;
+			}
+
 		}
 
 		if(a >= b) {
-			mask.push_back(false);
+			mask[row] = false;
 			best(row) = a;
 		} else {
-			mask.push_back(true);
+			mask[row] = true;
 			best(row) = b;
 		}
 
@@ -532,6 +1036,23 @@ class ExplicitEvent : public EventBase {
 		// end row loop
 		////////////////////////////////////////////////////////////////
 
+		};
+
+		parallelFor(0, refined_spatial_grid.size(), hjbqvi.threads,
+				optimize);
+
+		if(warm) {
+			const bool stochastic = hjbqvi.semi_lagrangian() && !stencil
+					&& !hjbqvi.stochastic_control_optimizer;
+			const bool impulse = hjbqvi.explicit_impulse();
+			for(Index row = 0; row < refined_spatial_grid.size();
+					++row) {
+				warm->searches += stochastic + impulse;
+				warm->fallbacks += (stochastic
+					&& warm->stochastic_fallbacks[row])
+					+ (impulse
+					&& warm->impulse_fallbacks[row]);
+			}
 		}
 
 		return best;
@@ -558,7 +1079,9 @@ public:
 		Vector (&impulse_control_vector)[ImpulseControlDimension],
 		Real time,
 		Real dt,
-		std::vector<bool> &mask
+		std::vector<char> &mask,
+		const SemiLagrangianStencil *stencil = nullptr,
+		WarmStart *warm = nullptr
 	) noexcept :
 		hjbqvi(hjbqvi),
 		refined_spatial_grid(refined_spatial_grid),
@@ -569,14 +1092,10 @@ public:
 		impulse_control_vector(impulse_control_vector),
 		time(time),
 		dt(dt),
-		mask(mask)
+		mask(mask),
+		stencil(stencil),
+		warm(warm)
 	{
-		// Space between ticks
-		offsets[0] = 1;
-		for(int d = 1; d < Dimension; ++d) {
-			offsets[d] = offsets[d-1]
-					* refined_spatial_grid[d-1].size();
-		}
 	}
 
 };
@@ -587,7 +1106,20 @@ public:
 
 public:
 
-Result solve(int refinement = 0) const {
+/**
+ * @param refinement The level of refinement.
+ * @param coarse The iterands converged to on a coarser level, used as initial
+ *               iterands on this one (or nullptr).
+ * @param record Whether or not to record the iterands converged to on this
+ *               level in Result::history.
+ * @return The result.
+ * @see QuantPDE::IterandHistory
+ */
+Result solve(
+	int refinement = 0,
+	std::shared_ptr<const IterandHistory<Dimension>> coarse = nullptr,
+	bool record = false
+) const {
 
 	const bool finite_horizon =
 			this->expiry < std::numeric_limits<Real>::infinity();
@@ -618,7 +1150,7 @@ Result solve(int refinement = 0) const {
 		impulse_control_vector[d] = refined_spatial_grid.vector();
 	}
 
-	std::vector<bool> mask;
+	std::vector<char> mask;
 	mask.reserve(refined_spatial_grid.size());
 
 	// Refine parameters
@@ -659,6 +1191,10 @@ Result solve(int refinement = 0) const {
 		this->transition
 	);
 
+	if(this->time_independent_coefficients) {
+		impulse.cacheRows();
+	}
+
 	MinPolicyIteration<
 		Dimension,
 		ImpulseControlDimension
@@ -671,6 +1207,27 @@ Result solve(int refinement = 0) const {
 	stochastic_policy.setIteration(tolerance_iteration);
 	impulse_policy.setIteration(tolerance_iteration);
 
+	// Coarse-to-fine warm start
+	std::shared_ptr<IterandHistory<Dimension>> history;
+	if(!this->explicit_control() && (coarse || record)) {
+		history = std::make_shared<IterandHistory<Dimension>>(
+				refined_spatial_grid, std::move(coarse));
+		tolerance_iteration.setHistory(history.get());
+	}
+
+	stochastic_policy.setThreads(threads);
+	impulse_policy.setThreads(threads);
+
+	if(this->stochastic_control_optimizer) {
+		stochastic_policy.setOptimizer(
+				*this->stochastic_control_optimizer);
+	}
+
+	if(warm_start_radius > 0) {
+		stochastic_policy.setWarmStart(warm_start_radius);
+		impulse_policy.setWarmStart(warm_start_radius);
+	}
+
 	std::unique_ptr<ReverseTimeIteration> stepper;
 	if(finite_horizon) {
 		if(variable_timesteps) {
@@ -754,7 +1311,34 @@ Result solve(int refinement = 0) const {
 	}
 
 	// Add events
+	std::unique_ptr<SemiLagrangianStencil> stencil;
+	std::unique_ptr<WarmStart> warm;
 	if(!this->fully_implicit()) {
+		if(this->semi_lagrangian()
+				&& this->time_independent_coefficients
+				&& !this->stochastic_control_optimizer) {
+			stencil = std::unique_ptr<SemiLagrangianStencil>(
+				new SemiLagrangianStencil(
+					*this,
+					refined_spatial_grid,
+					refined_stochastic_control_grid,
+					0.,
+					dt
+				)
+			);
+		}
+
+		if(warm_start_radius > 0) {
+			warm = std::unique_ptr<WarmStart>(
+				new WarmStart(
+					refined_spatial_grid,
+					refined_stochastic_control_grid,
+					refined_impulse_control_grid,
+					warm_start_radius
+				)
+			);
+		}
+
 		for(int e = 0; e < timesteps; ++e) {
 			const Real time = e * dt;
 
@@ -770,7 +1354,9 @@ Result solve(int refinement = 0) const {
 						impulse_control_vector,
 						time,
 						dt,
-						mask
+						mask,
+						stencil.get(),
+						warm.get()
 					)
 				)
 			);
@@ -780,7 +1366,9 @@ Result solve(int refinement = 0) const {
 	// Linear system solver
 	LinearSolver *solver;
 	if(this->bicgstab()) {
-		solver = new BiCGSTABSolver;
+		BiCGSTABSolver *bicgstab = new BiCGSTABSolver;
+		bicgstab->reusePreconditioner(preconditioner_reuse);
+		solver = bicgstab;
 	} else if(this->sparse_lu()) {
 		solver = new SparseLUSolver;
 	}
@@ -804,12 +1392,21 @@ Result solve(int refinement = 0) const {
 	#endif
 
 		auto u = iteration->solve(
-			refined_spatial_grid,
+			PointwiseMap<Dimension>(refined_spatial_grid, threads),
+			refined_spatial_grid.defaultInterpolantFactory(),
 			cauchy_data,
 			*root,
 			*solver
 		);
-		solution_vector = refined_spatial_grid.image(u);
+
+		// Evaluate the solution on the grid a block of nodes at a time
+		solution_vector = refined_spatial_grid.vector();
+		refined_spatial_grid.parallelForEachNode( [&] (Index begin,
+				Index end, const Points<Dimension> &points) {
+			Vector values;
+			u.interpolate(points, values);
+			solution_vector.segment(begin, end - begin) = values;
+		}, threads);
 
 	#ifdef QUANT_PDE_MODULES_HJBQVI_ITERATED_OPTIMAL_STOPPING
 	} else {
@@ -827,7 +1424,8 @@ Result solve(int refinement = 0) const {
 		tolerance_iteration.its.push_back(0);
 		do {
 			// Solution at the expiry
-			u_this[0] = refined_spatial_grid.image(cauchy_data);
+			u_this[0] = refined_spatial_grid.parallelImage(
+					cauchy_data, threads);
 
 			// Timestep (n) loop
 			converged = true;
@@ -959,7 +1557,8 @@ Result solve(int refinement = 0) const {
 			impulse_control_vector[d] =
 					impulse.control(d);
 		}
-		mask = penalty.constraintMask();
+		auto constraint_mask = penalty.constraintMask();
+		mask.assign(constraint_mask.begin(), constraint_mask.end());
 	}
 
 	// Mean iterations
@@ -989,6 +1588,22 @@ Result solve(int refinement = 0) const {
 		}
 	}
 
+	// Warm start statistics
+	Real warm_start_fallback_ratio = std::nan("");
+	if(warm_start_radius > 0) {
+		std::size_t searches = stochastic_policy.warmStartSearches()
+				+ impulse_policy.warmStartSearches();
+		std::size_t fallbacks = stochastic_policy.warmStartFallbacks()
+				+ impulse_policy.warmStartFallbacks();
+		if(warm) {
+			searches += warm->searches;
+			fallbacks += warm->fallbacks;
+		}
+		if(searches > 0) {
+			warm_start_fallback_ratio = (Real) fallbacks / searches;
+		}
+	}
+
 	if(this->explicit_control()) {
 		scaling_factor_dt = std::nan("");
 		iteration_tolerance = std::nan("");
@@ -996,8 +1611,16 @@ Result solve(int refinement = 0) const {
 
 	delete solver;
 
+	// Keep the coarse level alive only as long as it is needed
+	if(history) {
+		history->setCoarse(nullptr);
+		if(!record) {
+			history.reset();
+		}
+	}
+
 	// Return
-	return Result(
+	Result result(
 		refined_spatial_grid,
 		refined_stochastic_control_grid,
 		refined_impulse_control_grid,
@@ -1012,8 +1635,11 @@ Result solve(int refinement = 0) const {
 		mean_inner_iterations,
 		mean_solver_iterations,
 
-		seconds
+		seconds,
+		warm_start_fallback_ratio
 	);
+	result.history = std::move(history);
+	return result;
 
 }
 
@@ -1053,6 +1679,11 @@ Result solve(int refinement = 0) const {
 	const Real scaling_factor;
 	const Real iteration_tolerance;
 
+	// A boundary routine appends the off-diagonal entries of its row (as
+	// column-value pairs) and returns its contribution to the diagonal; it
+	// must not touch shared state, as rows are assembled concurrently
+	typedef std::vector<std::pair<Index, Real>> boundary_entries;
+
 	typedef std::function< Real (
 		const HJBQVI &,
 		const RectilinearGrid<Dimension> &,
@@ -1060,7 +1691,7 @@ Result solve(int refinement = 0) const {
 		const Real (&)[1+Dimension+StochasticControlDimension],
 		const Index (&)[Dimension],
 		const Index (&)[Dimension],
-		Matrix &, Index
+		Index, boundary_entries &
 	) > boundary_routine;
 
 private:
@@ -1080,6 +1711,18 @@ private:
 
 	int refinement_mask;
 
+	unsigned threads;
+
+	int warm_start_radius;
+
+	bool coarse_to_fine;
+	bool coarse_to_fine_savings;
+
+	Real preconditioner_reuse;
+
+	std::shared_ptr<const ControlOptimizer<StochasticControlDimension>>
+			stochastic_control_optimizer;
+
 public:
 
 	template <typename R>
@@ -1120,6 +1763,13 @@ public:
 	bool sparse_lu () const
 	{ return solver & HJBQVISolver::SPARSE_LU; }
 
+	bool coarse_to_fine_warm_start() const
+	{ return coarse_to_fine; }
+	bool measure_coarse_to_fine_savings() const
+	{ return coarse_to_fine_savings; }
+	unsigned threads_used() const
+	{ return threads; }
+
 	HJBQVI(
 		int timesteps,
 		const std::array<Axis, Dimension> &spatial_axes,
@@ -1198,7 +1848,16 @@ public:
 
 		drop_semi_lagrangian_off_grid(false),
 
-		refinement_mask(0)
+		refinement_mask(0),
+
+		threads(1),
+
+		warm_start_radius(0),
+
+		coarse_to_fine(false),
+		coarse_to_fine_savings(false),
+
+		preconditioner_reuse(0.)
 	{
 		// TODO: Proper exceptions
 
@@ -1264,6 +1923,47 @@ public:
 	void useBiCGSTABSolver() { solver = HJBQVISolver::BICGSTAB; }
 	void useSparseLUSolver() { solver = HJBQVISolver::SPARSE_LU; }
 	void doNotRefineAxis(int k) { refinement_mask |= (1 << k); }
+	void useThreads(unsigned n = 0) { threads = n; } // 0: all hardware threads
+
+	/**
+	 * Finds the optimal stochastic control at each node with an optimizer
+	 * (e.g. a BrentSearch bracketed on a coarse control grid) instead of
+	 * searching the stochastic control grid exhaustively. Consider also
+	 * calling disableStochasticControlRefinement().
+	 */
+	void useStochasticControlOptimizer(std::shared_ptr<const
+			ControlOptimizer<StochasticControlDimension>> optimizer)
+			{ stochastic_control_optimizer = std::move(optimizer); }
+
+	/**
+	 * Searches for the optimal controls at each node in a box of the given
+	 * radius (in control grid nodes) around the ones found at the previous
+	 * timestep, searching every control only when the optimum lands on the
+	 * edge of the box. This assumes the optimal controls vary slowly in time.
+	 */
+	void useWarmStart(int radius = 1) { warm_start_radius = radius; }
+
+	/**
+	 * Starts each level of refinement in HJBQVI_main from the solution (at
+	 * each time) of the previous level, interpolated onto the finer grid.
+	 * The initial policies, active sets and linear solver guesses are then
+	 * nearly converged. This has no effect on explicit control schemes.
+	 * @param measure If true, HJBQVI_main also solves each warm-started
+	 *                level from a cold start (doubling the work) and
+	 *                reports the mean number of policy iterations saved.
+	 * @see QuantPDE::IterandHistory
+	 */
+	void useCoarseToFineWarmStart(bool measure = false)
+	{ coarse_to_fine = true; coarse_to_fine_savings = measure; }
+
+	/**
+	 * Keeps the BiCGSTAB preconditioner from one (policy) iteration to the
+	 * next as long as at most the given fraction of the rows of the matrix
+	 * change.
+	 * @see QuantPDE::BiCGSTABSolver::reusePreconditioner
+	 */
+	void reuseBiCGSTABPreconditioner(Real fraction = 0.05)
+			{ preconditioner_reuse = fraction; }
 
 };
 
@@ -1275,7 +1975,9 @@ public:
 	const Real (&args)[1+Dimension+StochasticControlDimension], \
 	const int (&i)[Dimension], \
 	const Index (&offsets)[Dimension], \
-	Matrix &A, Index row
+	Index row, \
+	typename HJBQVI<Dimension, StochasticControlDimension, \
+			ImpulseControlDimension>::boundary_entries &entries
 
 template <
 	Index Dimension,
@@ -1334,7 +2036,7 @@ Real HJBQVIZeroDiffusionRightBoundary(
 	}
 
 	const Real alpha = - mu / dxb;
-	A.insert(row, row - offsets[d]) = -alpha;
+	entries.push_back( std::make_pair(row - offsets[d], -alpha) );
 	return alpha;
 
 }
@@ -1360,14 +2062,27 @@ typename HJBQVI<
 	int max_refinement = 0,
 	int min_refinement = 0,
 	std::ostream &out = std::cout,
-	bool verbose = true
+	bool verbose = true,
+	unsigned threads = 1
 ) {
 
+	assert(min_refinement <= max_refinement);
+
+	typedef HJBQVI<
+		Dimension,
+		StochasticControlDimension,
+		ImpulseControlDimension
+	> Problem;
+	typedef typename Problem::Result Result;
+
 	out.precision(12);
 
 	const int spacing = 23;
 	auto space = [=] () { return std::setw(spacing); };
 
+	const bool warm = hjbqvi.coarse_to_fine_warm_start();
+	const bool savings = warm && hjbqvi.measure_coarse_to_fine_savings();
+
 	// Headers
 	out
 		<< space() << "Spatial Nodes"
@@ -1381,9 +2096,15 @@ typename HJBQVI<
 		<< space() << "Value"
 		<< space() << "Change"
 		<< space() << "Ratio"
+		<< space() << "Extrapolated"
 		<< space() << "Execution Time (sec)"
-		<< std::endl
 	;
+	if(savings) {
+		out << space() << "Policy Its Saved";
+	}
+	out << std::endl;
+
+	std::shared_ptr<const IterandHistory<Dimension>> history;
 
 	Real
 		previousValue = nan(""),
@@ -1393,9 +2114,63 @@ typename HJBQVI<
 		ratio
 	;
 
-	int refinement = min_refinement;
-	while(1) {
-		auto result = hjbqvi.solve(refinement);
+	// Levels are independent unless they are warm-started from one another
+	if(warm) {
+		threads = 1;
+	}
+
+	// Each level starts its own thread pools (see HJBQVI::useThreads);
+	// split those threads between the levels running concurrently so as
+	// not to run (levels x threads) threads at once
+	const Index levels = max_refinement - min_refinement + 1;
+	unsigned concurrent = threads == 0 ? hardwareThreads() : threads;
+	if((Index) concurrent > levels) {
+		concurrent = levels;
+	}
+	Problem problem(hjbqvi);
+	if(concurrent > 1) {
+		const unsigned inner = hjbqvi.threads_used() == 0
+				? hardwareThreads() : hjbqvi.threads_used();
+		problem.useThreads(inner > concurrent ? inner / concurrent
+				: 1);
+	}
+
+	std::vector<std::unique_ptr<Result>> results(
+			max_refinement - min_refinement + 1);
+
+	// Mean number of policy iterations from a cold start of each level;
+	// the first level is always cold-started
+	std::vector<Real> cold(max_refinement - min_refinement + 1, nan(""));
+
+	auto solve = [&] (Index refinement) {
+		std::shared_ptr<const IterandHistory<Dimension>> coarse;
+		if(warm) {
+			coarse = std::move(history);
+		}
+
+		if(savings && coarse) {
+			cold[refinement - min_refinement] = problem.solve(
+					refinement).mean_inner_iterations;
+		}
+
+		results[refinement - min_refinement] = std::unique_ptr<Result>(
+			new Result(problem.solve(
+				refinement,
+				std::move(coarse),
+				warm && refinement < max_refinement
+			))
+		);
+		if(warm) {
+			history = results[refinement - min_refinement]
+					->history;
+		}
+		if(savings && refinement == min_refinement) {
+			cold[0] = results[0]->mean_inner_iterations;
+		}
+	};
+
+	auto print = [&] (Index refinement) {
+		const Result &result = *results[refinement - min_refinement];
 
 		PiecewiseLinear<Dimension> u(
 			result.spatial_grid,
@@ -1409,6 +2184,9 @@ typename HJBQVI<
 		previousValue = value;
 		previousChange = change;
 
+		// Richardson extrapolation with the observed ratio
+		const Real extrapolated = value + change / (ratio - 1.);
+
 		// Print
 		out
 			<< space() << result.spatial_grid.size()
@@ -1422,58 +2200,63 @@ typename HJBQVI<
 			<< space() << value
 			<< space() << change
 			<< space() << ratio
+			<< space() << extrapolated
 			<< space() << result.execution_time_seconds
-			<< std::endl
 		;
+		if(savings) {
+			out << space() << cold[refinement - min_refinement]
+					- result.mean_inner_iterations;
+		}
+		out << std::endl;
+
+		// Only the finest level is kept
+		if(refinement < max_refinement) {
+			results[refinement - min_refinement].reset();
+		}
+	};
 
-		if(refinement++ == max_refinement) { if(verbose) {
-			// Print header
-			out << std::endl; // Extra spacing
+	parallelForInOrder(min_refinement, max_refinement + 1, threads, solve,
+			print);
+
+	const Result &result = *results.back();
+
+	if(verbose) {
+		// Print header
+		out << std::endl; // Extra spacing
+		for(int d = 0; d < Dimension; ++d) {
+			out << space() << ("x_" + std::to_string(d+1));
+		}
+		out << space() << "Value u(t=0, x)";
+		for(int d = 0; d < StochasticControlDimension; ++d) {
+			out << space() << ("Stochastic Control w_"
+					+ std::to_string(d+1));
+		}
+		for(int d = 0; d < ImpulseControlDimension; ++d) {
+			out << space() << ("Impulse Control z_"
+					+ std::to_string(d+1));
+		}
+		out << std::endl;
+
+		int k = 0;
+		for(auto node : result.spatial_grid) {
 			for(int d = 0; d < Dimension; ++d) {
-				out << space() << ("x_" + std::to_string(d+1));
+				out << space() << node[d];
 			}
-			out << space() << "Value u(t=0, x)";
+			out << space() << result.solution_vector(k);
 			for(int d = 0; d < StochasticControlDimension; ++d) {
-				out << space() << ("Stochastic Control w_"
-						+ std::to_string(d+1));
+				out << space() << result
+					.stochastic_control_vector[d](k);
 			}
 			for(int d = 0; d < ImpulseControlDimension; ++d) {
-				out << space() << ("Impulse Control z_"
-						+ std::to_string(d+1));
+				out << space() << result
+					.impulse_control_vector[d](k);
 			}
 			out << std::endl;
-
-			int k = 0;
-			for(auto node : result.spatial_grid) {
-				for(int d = 0; d < Dimension; ++d) {
-					out << space() << node[d];
-				}
-				out << space() << result.solution_vector(k);
-				for(
-					int d = 0;
-					d < StochasticControlDimension;
-					++d
-				) {
-					out << space() << result
-						.stochastic_control_vector
-						[d](k)
-					;
-				}
-				for(
-					int d = 0;
-					d < ImpulseControlDimension;
-					++d
-				) {
-					out << space() << result
-						.impulse_control_vector
-						[d](k)
-					;
-				}
-				out << std::endl;
-				++k;
-			}
-		} return result; }
+			++k;
+		}
 	}
+
+	return result;
 }
 
 } // namespace Modules
@@ -1,14 +1,179 @@
 #ifndef QUANT_PDE_MODULES_LAMBDAS_DENSITIES_HPP
 #define QUANT_PDE_MODULES_LAMBDAS_DENSITIES_HPP
 
-#include <cmath> // std::exp, std::log, std::sqrt, std::pow
+#include <cmath>       // std::cos, std::erfc, std::exp, std::expm1, std::log,
+                      // std::pow, std::sin, std::sqrt
+#include <complex>     // std::complex
+#include <functional>  // std::function
+#include <limits>      // std::numeric_limits
+#include <type_traits> // std::enable_if, std::decay, std::is_same
+#include <utility>     // std::forward
 
 namespace QuantPDE {
 
 namespace Modules {
 
 /**
- * Returns a lambda function for the probability density
+ * A jump amplitude probability density \f$g\f$, optionally accompanied by
+ * closed forms for the quantities that the jump-diffusion operators derive
+ * from it. Those without a closed form are computed by quadrature.
+ *
+ * The closed forms are in terms of the log amplitude \f$y=\ln J\f$, whose
+ * density is \f$g\left(e^y\right)e^y\f$.
+ */
+class JumpDensity final {
+
+public:
+
+	/**
+	 * The probability \f$P\left(a \leq \ln J < b\right)\f$ at time t,
+	 * with arguments (t, a, b).
+	 */
+	typedef std::function<Real (Real, Real, Real)> Probability;
+
+	/**
+	 * \f$\kappa = E\left[J\right] - 1\f$ at time t.
+	 */
+	typedef std::function<Real (Real)> Kappa;
+
+	/**
+	 * The characteristic function
+	 * \f$E\left[e^{i \omega \ln J}\right]\f$ at time t, with arguments
+	 * (t, omega).
+	 */
+	typedef std::function<std::complex<Real> (Real, Real)>
+			CharacteristicFunction;
+
+private:
+
+	typedef AdaptiveQuadrature1<GaussKronrodRule1> Integral;
+
+	Noncontrollable<1> density;
+
+	Probability _probability;
+	Kappa _kappa;
+	CharacteristicFunction _characteristicFunction;
+
+public:
+
+	/**
+	 * Constructor for a density without closed forms.
+	 * @param density The density, either constant, a function of the
+	 *                amplitude, or a function of time and the amplitude.
+	 */
+	template <typename F, typename = typename std::enable_if<
+			!std::is_same<typename std::decay<F>::type,
+			JumpDensity>::value>::type>
+	JumpDensity(F &&density) noexcept
+			: density( std::forward<F>(density) ) {
+	}
+
+	/**
+	 * Constructor.
+	 * @param density The density.
+	 * @param probability The probability of the log amplitude lying in an
+	 *                    interval (or empty to integrate the density).
+	 * @param kappa The expected relative jump size (or empty to integrate
+	 *              the density).
+	 * @param characteristicFunction The characteristic function of the log
+	 *                               amplitude (or empty to integrate the
+	 *                               density).
+	 */
+	template <typename F>
+	JumpDensity(
+		F &&density,
+		Probability probability,
+		Kappa kappa,
+		CharacteristicFunction characteristicFunction = nullptr
+	) noexcept :
+		density( std::forward<F>(density) ),
+		_probability( std::move(probability) ),
+		_kappa( std::move(kappa) ),
+		_characteristicFunction( std::move(characteristicFunction) )
+	{
+	}
+
+	/**
+	 * @return The density at time t and amplitude x.
+	 */
+	Real operator()(Real t, Real x) const {
+		return density(t, x);
+	}
+
+	/**
+	 * @return True if and only if the density does not depend on time.
+	 */
+	bool isConstantInTime() const {
+		return density.isConstantInTime();
+	}
+
+	/**
+	 * @return \f$P\left(a \leq \ln J < b\right)\f$ at time t.
+	 */
+	Real probability(Real t, Real a, Real b) const {
+		if(_probability) {
+			return _probability(t, a, b);
+		}
+
+		return Integral(
+			[&] (Real y) { return density(t, std::exp(y))
+					* std::exp(y); },
+			a
+		)(b);
+	}
+
+	/**
+	 * @return \f$\kappa = E\left[J\right] - 1\f$ at time t.
+	 */
+	Real kappa(Real t) const {
+		if(_kappa) {
+			return _kappa(t);
+		}
+
+		return Integral(
+			[&] (Real y) { return std::exp(2 * y)
+					* density(t, std::exp(y)); },
+			-std::numeric_limits<Real>::infinity()
+		)( std::numeric_limits<Real>::infinity() ) - 1.;
+	}
+
+	/**
+	 * @return \f$E\left[e^{i \omega \ln J}\right]\f$ at time t.
+	 */
+	std::complex<Real> characteristicFunction(Real t, Real omega) const {
+		if(_characteristicFunction) {
+			return _characteristicFunction(t, omega);
+		}
+
+		const Real inf = std::numeric_limits<Real>::infinity();
+		auto weight = [&] (Real y) { return density(t, std::exp(y))
+				* std::exp(y); };
+		return std::complex<Real>(
+			Integral([&] (Real y) { return std::cos(omega * y)
+					* weight(y); }, -inf)(inf),
+			Integral([&] (Real y) { return std::sin(omega * y)
+					* weight(y); }, -inf)(inf)
+		);
+	}
+
+};
+
+/**
+ * @return \f$P\left(a \leq Z < b\right)\f$ for a standard normal
+ *         \f$Z\f$ (computed in the tail that avoids cancellation).
+ */
+inline Real normalProbability(Real a, Real b) {
+	if(a > 0.) {
+		return .5 * ( std::erfc(a / std::sqrt(2.))
+				- std::erfc(b / std::sqrt(2.)) );
+	}
+
+	return .5 * ( std::erfc(-b / std::sqrt(2.))
+			- std::erfc(-a / std::sqrt(2.)) );
+}
+
+/**
+ * Returns the probability density
  * \f$
  * 	f(J) =
  * 		\frac{1}{J\sigma\sqrt{2\pi}}
@@ -16,12 +181,12 @@ namespace Modules {
  * \f$
  * @param mu
  * @param sigma
- * @return A lambda function.
+ * @return The density (with closed forms).
  */
-inline Function1 lognormal(Real mu = 0., Real sigma = 1.) {
+inline JumpDensity lognormal(Real mu = 0., Real sigma = 1.) {
 	assert(sigma > 0.);
 
-	return [mu, sigma] (Real x) -> Real {
+	Function1 density = [mu, sigma] (Real x) -> Real {
 		assert(x > 0.);
 
 		if(x == 0.) {
@@ -32,10 +197,27 @@ inline Function1 lognormal(Real mu = 0., Real sigma = 1.) {
 				* std::exp( -((std::log(x)-mu)*(std::log(x)-mu))
 				/ (2. * sigma * sigma) );
 	};
+
+	// The log amplitude is normal with mean mu and deviation sigma
+	return JumpDensity(
+		std::move(density),
+		[mu, sigma] (Real, Real a, Real b) {
+			return normalProbability( (a - mu) / sigma,
+					(b - mu) / sigma );
+		},
+		[mu, sigma] (Real) {
+			return std::exp(mu + sigma * sigma / 2.) - 1.;
+		},
+		[mu, sigma] (Real, Real omega) {
+			return std::exp( std::complex<Real>(
+					-sigma * sigma * omega * omega / 2.,
+					mu * omega ) );
+		}
+	);
 }
 
 /**
- * Returns a lambda function for the probability density
+ * Returns the probability density
  * \f$
  * 	f(J) =
  * 	       p  \eta_1 J^{-\eta_1 - 1} 1_{\{ J \geq 1 \} }
@@ -44,14 +226,14 @@ inline Function1 lognormal(Real mu = 0., Real sigma = 1.) {
  * @param p Probability of upward jump.
  * @param eta_1 The upward jump random variable has mean 1/eta_1.
  * @param eta_2 The downward jump random variable has mean 1/eta_2.
- * @return A lambda function.
+ * @return The density (with closed forms).
  */
-inline Function1 doubleExponential(Real p, Real eta_1, Real eta_2) {
+inline JumpDensity doubleExponential(Real p, Real eta_1, Real eta_2) {
 	assert(p >= 0.);
 	assert(eta_1 > 1.); // Ensures finite expectation
 	assert(eta_2 > 0.);
 
-	return [p, eta_1, eta_2] (Real x) -> Real {
+	Function1 density = [p, eta_1, eta_2] (Real x) -> Real {
 		assert(x > 0.);
 
 		if(x == 0.) {
@@ -62,6 +244,33 @@ inline Function1 doubleExponential(Real p, Real eta_1, Real eta_2) {
 			? (   p  * eta_1 * std::pow(x, -eta_1 - 1))
 			: ((1-p) * eta_2 * std::pow(x,  eta_2 - 1));
 	};
+
+	// The log amplitude is exponential with rate eta_1 (with probability
+	// p) or the negative of an exponential with rate eta_2
+	return JumpDensity(
+		std::move(density),
+		[p, eta_1, eta_2] (Real, Real a, Real b) {
+			if(a >= 0.) {
+				return p * ( std::exp(-eta_1 * a)
+						- std::exp(-eta_1 * b) );
+			}
+			if(b <= 0.) {
+				return (1-p) * ( std::exp(eta_2 * b)
+						- std::exp(eta_2 * a) );
+			}
+			return - (1-p) * std::expm1(eta_2 * a)
+					- p * std::expm1(-eta_1 * b);
+		},
+		[p, eta_1, eta_2] (Real) {
+			return p * eta_1 / (eta_1 - 1.)
+					+ (1-p) * eta_2 / (eta_2 + 1.) - 1.;
+		},
+		[p, eta_1, eta_2] (Real, Real omega) {
+			const std::complex<Real> i(0., 1.);
+			return p * eta_1 / (eta_1 - i * omega)
+					+ (1-p) * eta_2 / (eta_2 + i * omega);
+		}
+	);
 }
 
 } // Modules
@@ -2,6 +2,8 @@
 #define QUANT_PDE_MODULES_BLACK_SCHOLES_HPP
 
 #include <complex> // std::complex, std::conj
+#include <cstdint> // std::intmax_t
+#include <limits>  // std::numeric_limits
 #include <utility> // std::forward
 #include <vector>  // std::vector
 
@@ -43,22 +45,19 @@ protected:
 
 	const RectilinearGrid<Dimension> &G;
 
-	// TODO: Increase dimensions
+	// Jump arrival rate and jump amplitude density
 	Controllable<Dimension> l;
-	Noncontrollable<Dimension> g;
+	JumpDensity g;
+
+	unsigned threads;
 
 	void pass(Real) {
 	}
 
 	inline void computeKappa(Real t) {
-		typedef AdaptiveQuadrature1<TrapezoidalRule1<>> Integral;
-
 		// Computes (E[y]-1) where y is an r.v. with probability density
 		// g : [0, Infinity) -> [0, Infinity)
-		kappa = Integral(
-			[=] (Real y) { return exp(2 * y) * g(t, exp(y)); },
-			-std::numeric_limits<Real>::infinity()
-		)( std::numeric_limits<Real>::infinity() ) - 1.;
+		kappa = g.kappa(t);
 	}
 
 	/**
@@ -86,7 +85,8 @@ protected:
 		q( std::forward<F3>(dividends) ),
 		G( grid ),
 		l( std::forward<F4>(meanArrivalTime) ),
-		g( std::forward<F5>(jumpAmplitudeDensity) )
+		g( std::forward<F5>(jumpAmplitudeDensity) ),
+		threads( 1 )
 	{
 		this->registerControl(r);
 		this->registerControl(v);
@@ -124,7 +124,8 @@ public:
 		kappa( 0. ),
 		G( grid ),
 		l( 0. ),
-		g( 0. )
+		g( 0. ),
+		threads( 1 )
 	{
 		this->registerControl(r);
 		this->registerControl(v);
@@ -145,10 +146,10 @@ public:
 		(this->*_computeKappa)(t);
 
 		// Take the images of curried coefficient functions
-		auto rvec = G.image( curry<Dimension+1>(r, t) );
-		auto vvec = G.image( curry<Dimension+1>(v, t) );
-		auto qvec = G.image( curry<Dimension+1>(q, t) );
-		auto lvec = G.image( curry<Dimension+1>(l, t) );
+		auto rvec = G.parallelImage(curry<Dimension+1>(r, t), threads);
+		auto vvec = G.parallelImage(curry<Dimension+1>(v, t), threads);
+		auto qvec = G.parallelImage(curry<Dimension+1>(q, t), threads);
+		auto lvec = G.parallelImage(curry<Dimension+1>(l, t), threads);
 
 		// Interior points
 		// alpha_i dt V_{i-1}^{n+1} + (1 + (alpha_i + beta_i + r) dt)
@@ -234,6 +235,16 @@ public:
 				&& q.isConstantInTime() && l.isConstantInTime();
 	}
 
+	/**
+	 * Sets the number of threads used to evaluate the coefficients on the
+	 * grid (and, with jumps, to correlate the lines along the asset axis).
+	 * @param threads The number of threads (0 to use all hardware
+	 *                threads).
+	 */
+	void setThreads(unsigned threads) {
+		this->threads = threads;
+	}
+
 };
 
 typedef BlackScholes<1, 0> BlackScholes1;
@@ -266,15 +277,30 @@ typedef BlackScholes<1, 0> BlackScholes1;
  * boundary condition.
  *
  * The integral introduced by the jump term is handled using the FFT correlation
- * integral method described in @cite d2005robust .
+ * integral method described in @cite d2005robust . On a multidimensional grid,
+ * the correlation is applied along the asset axis on every line of the grid.
+ *
+ * @tparam SIndex The index of the risky asset.
 **/
+template <Index Dimension, Index SIndex>
 class BlackScholesJumpDiffusion final : public IterationNode,
-		public BlackScholes1 {
-		// TODO: Extend this to "multidimensional"
+		public BlackScholes<Dimension, SIndex> {
+
+	typedef BlackScholes<Dimension, SIndex> Base;
+
+	typedef Eigen::Matrix<std::complex<Real>, Eigen::Dynamic, 1>
+			ComplexVector;
+
+	// Buffers used to correlate a batch of lines
+	struct Workspace {
+		Eigen::FFT<Real> fft;
+		Vector line, samples, correlation;
+		ComplexVector spectrum;
+	};
 
 	inline RectilinearGrid1 initializeGrid() {
 		// Spatial axis
-		const Axis &S = G[0];
+		const Axis &S = this->G[SIndex];
 		const Index n = S.size();
 
 		// Take the number of points in the frequency domain to be the
@@ -296,36 +322,199 @@ class BlackScholesJumpDiffusion final : public IterationNode,
 		return RectilinearGrid1( Axis::uniform(x0, xf, N) );
 	}
 
-	void computeDensityFFT(Real t) {
-		// Tested 2014-07-05
+	/**
+	 * Builds the sparse matrix that linearly interpolates data on an axis
+	 * at the given (sorted) points, exactly as PiecewiseLinear1 does.
+	 */
+	static Matrix interpolationMatrix(const Axis &x, const Vector &points) {
+		const Index count = points.size();
+
+		std::vector<Index> indices(count);
+		std::vector<Real> weights(count);
+		linearInterpolationData(x, points.data(), count, indices.data(),
+				weights.data());
+
+		Matrix M(count, x.size());
+		M.reserve(2 * count);
+		for(Index k = 0; k < count; ++k) {
+			const Index i = indices[k];
+			const Real w = weights[k];
+
+			// Weights that are not bigger than epsilon are dropped,
+			// as in PiecewiseLinear
+			M.startVec(k);
+			if(w > epsilon) {
+				M.insertBack(k, i) = w;
+			}
+			if(1. - w > epsilon) {
+				M.insertBack(k, i + 1) = 1. - w;
+			}
+		}
+		M.finalize();
+
+		return M;
+	}
+
+	void initializeOperators() {
+		// Spatial axis
+		const Axis &S = this->G[SIndex];
+		const Index n = S.size();
+
+		// Evaluates Vbar(x) = V(exp(x)) at the frequency grid points
+		Vector points(N);
+		for(Index i = 0; i < N; ++i) {
+			points(i) = std::exp(x0 + i * dx);
+		}
+		sampling = interpolationMatrix(S, points);
+
+		// Evaluates the correlation at the interior points
+		Vector logS(n - 2);
+		for(Index i = 1; i < n - 1; ++i) {
+			logS(i - 1) = std::log(S[i]);
+		}
+		unsampling = interpolationMatrix(F[0], logS);
 
-		//typedef TrapezoidalRule1<> Integral;
-		typedef AdaptiveQuadrature1<TrapezoidalRule1<>> Integral;
+		// Space between S ticks and number of lines along the S axis
+		offset = 1;
+		for(Index d = 0; d < SIndex; ++d) {
+			offset *= this->G[d].size();
+		}
+		lines = this->G.size() / n;
+	}
 
-		// Transformed density
-		auto fbar = [&] (Real x) {
-			return g(t, std::exp(x)) * std::exp(x);
-		};
+	void computeDensityFFT(Real t) {
+		// Tested 2014-07-05
 
-		// Integrate density around grid points
-		std::vector<Real> fprime;
-		fprime.reserve(N);
+		// Integrate the transformed density g(exp(x)) exp(x) around
+		// grid points (in closed form if available)
+		Vector fprime(N);
 		for(Index i = 0; i <= N/2; ++i) {
 			// Integrate around x_i
 			const Real a = dx * (-.5 + i);
 			const Real b = dx * ( .5 + i);
-			fprime.push_back( Integral(fbar, a)(b) );
+			fprime(i) = this->g.probability(t, a, b);
 		}
 		for(Index i = N/2+1; i < N; ++i) {
 			// Integrate around x_{i - N}
 			const Real a = dx * (-.5 + i - N);
 			const Real b = dx * ( .5 + i - N);
-			fprime.push_back( Integral(fbar, a)(b) );
+			fprime(i) = this->g.probability(t, a, b);
 		}
 
-		// Compute FFT of transformed density
-		fprimeFFT.reserve(N);
-		fft.fwd(fprimeFFT, fprime);
+		// Compute FFT of transformed density (half spectrum)
+		fprimeFFT.resize(N / 2 + 1);
+		fft.fwd(fprimeFFT.data(), fprime.data(), N);
+	}
+
+	/**
+	 * Correlates the lines [begin, end) of V along the asset axis with
+	 * the density and writes the jump term to the same lines of b.
+	 */
+	void correlate(Workspace &work, const Vector &V, const Vector &lambda,
+			Index begin, Index end, Vector &b) {
+		const Index n = this->G[SIndex].size();
+
+		work.line.resize(n);
+		work.samples.resize(N);
+		work.spectrum.resize(N / 2 + 1);
+
+		for(Index k = begin; k < end; ++k) {
+			// First node of the line
+			const Index first = (k / offset) * offset * n
+					+ k % offset;
+
+			for(Index i = 0; i < n; ++i) {
+				work.line(i) = V(first + i * offset);
+			}
+
+			// Evaluate Vbar(x) = V(exp(x)) at the frequency grid
+			// points
+			work.samples.noalias() = sampling * work.line;
+
+			// Forward transform
+			work.fft.fwd(work.spectrum.data(), work.samples.data(),
+					N);
+
+			// Correlation with the density
+			for(Index i = 0; i < N / 2 + 1; ++i) {
+				work.spectrum(i) *= std::conj(fprimeFFT(i));
+			}
+
+			// Inverse transform (overwrite samples to save space)
+			work.fft.inv(work.samples.data(), work.spectrum.data(),
+					N);
+
+			work.correlation.noalias() = unsampling * work.samples;
+
+			// Left
+			b(first) = 0.;
+
+			// Interior points
+			for(Index i = 1; i < n - 1; ++i) {
+				const Index idx = first + i * offset;
+				b(idx) = lambda(idx) * work.correlation(i - 1);
+			}
+
+			// Right
+			b(first + (n - 1) * offset) = 0.;
+		}
+	}
+
+	/**
+	 * @return The jump term lambda(t) J V at time t (zero on the asset
+	 *         axis boundaries).
+	 */
+	Vector jumps(Real t, const Vector &V) {
+		// Compute FFT of density
+		(this->*_computeDensityFFT)(t);
+
+		// Jump arrival rate at each node
+		const Vector lambda = this->G.parallelImage(
+				curry<Dimension + 1>(this->l, t),
+				this->threads );
+
+		// Split the lines into one batch per thread, each with its own
+		// FFT and buffers
+		unsigned batches = this->threads == 0 ? hardwareThreads()
+				: this->threads;
+		if((Index) batches > lines) {
+			batches = lines;
+		}
+		if(workspaces.size() < batches) {
+			workspaces.resize(batches);
+			for(Workspace &work : workspaces) {
+				work.fft.SetFlag(Eigen::FFT<Real>::HalfSpectrum);
+			}
+		}
+
+		Vector b = this->G.vector();
+
+		parallelFor(0, batches, batches, [&] (Index k) {
+			correlate(
+				workspaces[k],
+				V,
+				lambda,
+				(Index) ((std::intmax_t) lines * k / batches),
+				(Index) ((std::intmax_t) lines * (k + 1)
+						/ batches),
+				b
+			);
+		});
+
+		return b;
+	}
+
+	virtual void clear() {
+		starting = true;
+	}
+
+	virtual void onIterationStart() {
+		if(implicit && starting) {
+			// Solution at the start of the timestep
+			initial = this->iterand(0);
+			initial_time = std::numeric_limits<Real>::quiet_NaN();
+			starting = false;
+		}
 	}
 
 	Eigen::FFT<Real> fft;
@@ -334,7 +523,21 @@ class BlackScholesJumpDiffusion final : public IterationNode,
 	Real x0, dx;
 	RectilinearGrid1 F;
 
-	std::vector<std::complex<Real>> fprimeFFT;
+	// Linear interpolation from the asset axis to the frequency grid and
+	// from the frequency grid back to the interior of the asset axis
+	Matrix sampling, unsampling;
+
+	Index offset, lines;
+
+	std::vector<Workspace> workspaces;
+
+	// Implicit jumps: the solution at the start of the timestep and its
+	// jump term (at initial_time)
+	bool implicit, starting;
+	Vector initial, initial_jumps;
+	Real initial_time;
+
+	ComplexVector fprimeFFT;
 
 	void (BlackScholesJumpDiffusion::*_computeDensityFFT)(Real);
 
@@ -360,7 +563,7 @@ public:
 		F4 &&meanArrivalTime,
 		F5 &&jumpAmplitudeDensity
 	) noexcept :
-		BlackScholes(
+		Base(
 			grid,
 			std::forward<F1>(interest),
 			std::forward<F2>(volatility),
@@ -368,9 +571,17 @@ public:
 			std::forward<F4>(meanArrivalTime),
 			std::forward<F5>(jumpAmplitudeDensity)
 		),
-		F( initializeGrid() )
+		F( initializeGrid() ),
+		implicit(false),
+		starting(true),
+		initial_time(std::numeric_limits<Real>::quiet_NaN())
 	{
-		if(g.isConstantInTime()) {
+		// Only the nonnegative frequencies of a real signal are kept
+		fft.SetFlag(Eigen::FFT<Real>::HalfSpectrum);
+
+		initializeOperators();
+
+		if(this->g.isConstantInTime()) {
 			// Precompute once
 			computeDensityFFT(-1.);
 			_computeDensityFFT = &BlackScholesJumpDiffusion::pass;
@@ -381,86 +592,56 @@ public:
 		}
 	}
 
-	virtual Matrix A(Real t) {
-		return BlackScholes::A(t);
+	/**
+	 * Treats the jump term implicitly instead of explicitly.
+	 *
+	 * This operator must then be attached to an inner iteration of the
+	 * timestepper (e.g. a ToleranceIteration) on which the jump term is
+	 * lagged by one fixed-point iteration. With the Crank-Nicolson method,
+	 * each fixed-point iteration solves
+	 * \f[
+	 * \left[ I + \theta \Delta t A \right] V^{k+1}
+	 * = \left[ I - \left( 1 - \theta \right) \Delta t A \right] V^n
+	 * + \theta \Delta t \lambda J V^k
+	 * + \left( 1 - \theta \right) \Delta t \lambda J V^n
+	 * \f]
+	 * where \f$A\f$ excludes the integral, so that the factorization of the
+	 * matrix is reused across fixed-point iterations (provided that the
+	 * timestep and coefficients are constant). The jump term of \f$V^n\f$ is
+	 * only computed once per timestep.
+	 */
+	void useImplicitJumps() {
+		implicit = true;
 	}
 
-	// TODO: Deprecate this in lieu of something more clever
-	virtual Vector b(Real) {
-		// Spatial axis
-		const Axis &S = G[0];
-		const Index n = S.size();
-
-		// Discretize the jump term explicitly using [1]
-
-		// Explicit time
-		Real t0 = this->time(0);
-
-		// Compute FFT of density
-		(this->*_computeDensityFFT)(t0);
-
-		// Transformed solution
-		Vector v = this->iterand(0);
-		PiecewiseLinear1 V(G, v);
-		auto Vbar = [&] (Real x) { return V( std::exp(x) ); };
-
-		// Buffers
-		std::vector<Real> buffer;
-		std::vector<std::complex<Real>> bufferFFT;
-
-		// Evaluate Vbar at the grid points
-		buffer.reserve(N);
-		for(Index i = 0; i < N; ++i) {
-			buffer.push_back( Vbar(x0 + i * dx) );
-		}
+	virtual Matrix A(Real t) {
+		return Base::A(t);
+	}
 
-		// Forward transform
-		bufferFFT.reserve(N);
-		fft.fwd(bufferFFT, buffer);
+	virtual Vector b(Real t) {
+		// Discretize the jump term using [1]
 
-		// Multiplication (overwrite bufferFFT to save space)
-		for(Index i = 0; i < N; ++i) {
-			bufferFFT[i] *= std::conj(fprimeFFT[i]);
+		if(!implicit) {
+			// Explicit time
+			return jumps(this->time(0), this->iterand(0));
 		}
 
-		// Inverse fft (overwrite buffer to save space)
-		fft.inv(buffer, bufferFFT);
-
-		// Copy results to vector so that we can use existing
-		// interpolation methods
-		/*Vector correlation = F.vector();
-		for(Index i = 0; i < N; ++i) {
-			correlation(i) = buffer[i];
+		if(t == this->nextTime()) {
+			// Latest fixed-point iterate
+			return jumps(t, this->iterand(0));
 		}
-		PiecewiseLinear1 h(F, std::move(correlation));*/
-
-		// No need to do the above any longer since PiecewiseLinear
-		// is templated to accept any structure indexable by operator[]
-		// (slightly more efficient)
-		PiecewiseLinear< 1, std::vector<Real> > h(
-			F,                // Frequency grid
-			std::move(buffer) // Data points
-		);
-
-		Vector b = G.vector();
 
-		// Left
-		b(0) = 0.;
-
-		// Interior points
-		for(Index i = 1; i < n - 1; ++i) {
-			b(i) = l(t0, S[i]) * h(std::log(S[i]));
+		// Solution at the start of the timestep
+		if(!(t == initial_time)) {
+			initial_jumps = jumps(t, initial);
+			initial_time = t;
 		}
-
-		// Right
-		b(n - 1) = 0.;
-
-		return b;
+		return initial_jumps;
 	}
 
 };
 
-typedef BlackScholesJumpDiffusion BlackScholesJumpDiffusion1;
+typedef BlackScholesJumpDiffusion<1, 0> BlackScholesJumpDiffusion1;
 
 } // Modules
 
@@ -105,8 +105,7 @@ public:
 
 		Axis axes[Dimension];
 		for(Index i = 0; i < Dimension; ++i) {
-			axes[i].length = configuration[key][i].size();
-			axes[i].n = new Real[axes[i].length];
+			axes[i] = Axis( configuration[key][i].size() );
 			for(Index j = 0; j < axes[i].length; ++j) {
 				axes[i].n[j] = (Real) configuration[key][i][j]
 						.asDouble();
@@ -33,6 +33,7 @@ class ResultsBuffer {
 	const int precision; const int spacing;
 	const bool ratio;
 	std::unique_ptr<RectilinearGrid<Dimension>> grid;
+	unsigned threads;
 
 public:
 
@@ -45,7 +46,11 @@ public:
 	 * @param precision Level of numerical precision to display.
 	 * @param spacing Amount of whitespace in table.
 	 * @param ratio Whether or not to print the convergence ratio.
+	 * @param threads The number of threads on which to run the levels of
+	 *                refinement (0 to use all hardware threads). If this
+	 *                is not 1, run must be reentrant.
 	 * @return A string.
+	 * @see QuantPDE::ResultsBuffer::setThreads
 	 */
 	template <typename F>
 	ResultsBuffer(
@@ -53,14 +58,16 @@ public:
 		const Headers &headers = {},
 		int kn = 5, int k0 = 0,
 		int precision = 6, int spacing = 23,
-		bool ratio = true
+		bool ratio = true,
+		unsigned threads = 1
 	) noexcept :
 		run( std::forward<F>(run) ),
 		headers(headers),
 		kn(kn), k0(k0),
 		precision(precision), spacing(spacing),
 		ratio(ratio),
-		grid(nullptr)
+		grid(nullptr),
+		threads(threads)
 	{}
 
 	// TODO: Might need to implement these in the future
@@ -72,8 +79,25 @@ public:
 				new RectilinearGrid<Dimension>(grid));
 	}
 
+	/**
+	 * Runs the levels of refinement concurrently on the given number of
+	 * threads, starting with the finest (most expensive) one. Rows are
+	 * still printed in order, as soon as they are available. The function
+	 * to run must be safe to call concurrently.
+	 * @param threads The number of threads (0 to use all hardware threads).
+	 * @see QuantPDE::parallelForInOrder
+	 */
+	void setThreads(unsigned threads) {
+		this->threads = threads;
+	}
+
 	/**
 	 * Runs and pushes output to the specified stream.
+	 *
+	 * If the convergence ratio is printed, so is the Richardson
+	 * extrapolation \f$v_k+\left(v_k-v_{k-1}\right)/\left(r-1\right)\f$
+	 * of the values, where \f$r\f$ is the ratio (an estimate of
+	 * \f$2^p\f$ for a method that converges at order \f$p\f$).
 	 * @param os The output stream to print to.
 	 */
 	void stream(std::ostream &os = std::cout) {
@@ -89,6 +113,7 @@ public:
 			os
 				<< std::setw(spacing) << "Change"
 				<< std::setw(spacing) << "Ratio"
+				<< std::setw(spacing) << "Extrapolated"
 			;
 		}
 		os << std::setw(spacing) << "Timing (Seconds)" << std::endl;
@@ -97,15 +122,25 @@ public:
 
 		Real previousValue = nan(""), previousChange = nan("");
 
-		// Results
-		for(int k = k0; k <= kn; ++k) {
-			// Run
-			Real seconds;
+		std::vector<std::unique_ptr<ResultsTuple<Dimension>>> rets(
+				kn - k0 + 1);
+		std::vector<Real> timings(kn - k0 + 1);
+
+		// Run
+		auto compute = [&] (Index k) {
 			auto start = std::chrono::steady_clock::now();
-			auto ret = run(k); // Unpack
+			rets[k - k0] = std::unique_ptr<ResultsTuple<Dimension>>(
+					new ResultsTuple<Dimension>(run(k)));
 			auto end = std::chrono::steady_clock::now();
 			auto diff = end - start;
-			seconds = std::chrono::duration<Real>(diff).count();
+			timings[k - k0] = std::chrono::duration<Real>(diff)
+					.count();
+		};
+
+		// Results
+		auto print = [&] (Index k) {
+			const Real seconds = timings[k - k0];
+			const ResultsTuple<Dimension> &ret = *rets[k - k0];
 
 			auto results = std::get<0>(ret);
 			auto solution = std::get<1>(ret);
@@ -132,10 +167,13 @@ public:
 			if(ratio) {
 				const Real change = value - previousValue;
 				const Real ratio = previousChange / change;
+				const Real extrapolated = value + change
+						/ (ratio - 1.);
 
 				os
 					<< std::setw(spacing) << change
 					<< std::setw(spacing) << ratio
+					<< std::setw(spacing) << extrapolated
 				;
 
 				previousChange = change;
@@ -164,7 +202,11 @@ public:
 					<< accessor( *grid, solution, spacing )
 				;
 			}
-		}
+
+			rets[k - k0].reset();
+		};
+
+		parallelForInOrder(k0, kn + 1, threads, compute, print);
 	}
 
 };
@@ -36,7 +36,7 @@ Real
 	jump_up_mean_reciprocal, jump_down_mean_reciprocal
 ;
 int N;
-bool call, digital, variable;
+bool call, digital, variable, implicit_jumps;
 RectilinearGrid1 *grid;
 
 ResultsTuple1 run(int k) {
@@ -109,11 +109,25 @@ ResultsTuple1 run(int k) {
 		divs, // Dividend rate
 		jump_arrival_rate, jump_density
 	);
-	bs.setIteration(stepper);
 
-	typedef ReverseBDFOne Discretization;
-	Discretization discretization(refined_grid, bs);
-	discretization.setIteration(stepper);
+	// Implicit jumps are resolved by a fixed-point iteration within each
+	// timestep
+	ToleranceIteration tolerance;
+	if(implicit_jumps) {
+		stepper.setInnerIteration(tolerance);
+		bs.setIteration(tolerance);
+		bs.useImplicitJumps();
+	} else {
+		bs.setIteration(stepper);
+	}
+
+	// Fully implicit with explicit jumps, Crank-Nicolson (with Rannacher
+	// smoothing) with implicit jumps
+	unique_ptr<IterationNode> discretization(implicit_jumps
+		? (IterationNode *) new ReverseRannacher(refined_grid, bs)
+		: (IterationNode *) new ReverseBDFOne(refined_grid, bs)
+	);
+	discretization->setIteration(stepper);
 
 	////////////////////////////////////////////////////////////////////////
 	// Running
@@ -126,10 +140,10 @@ ResultsTuple1 run(int k) {
 	SparseLUSolver solver;
 
 	auto solution = stepper.solve(
-		refined_grid,   // Domain
-		payoff,         // Initial condition
-		discretization, // Root of linear system tree
-		solver          // Linear system solver
+		refined_grid,    // Domain
+		payoff,          // Initial condition
+		*discretization, // Root of linear system tree
+		solver           // Linear system solver
 	);
 
 	////////////////////////////////////////////////////////////////////////
@@ -163,6 +177,7 @@ int main(int argc, char **argv) {
 	dS = getReal(configuration, "print_asset_price_step_size", S_0 / 10.);
 	jump_arrival_rate = getReal(configuration, "jump_arrival_rate", .1);
 	N = getInt(configuration, "initial_number_of_timesteps", 12);
+	implicit_jumps = getBool(configuration, "implicit_jumps", false);
 	RectilinearGrid1 default_grid( (S_0 * Axis::special) + (K * Axis::special) + (S_0 * Axis { 1000. }) + (K * Axis { 1000. }) );
 	RectilinearGrid1 tmp = getGrid(configuration, "initial_grid", default_grid);
 	grid = &tmp;
@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////////
+// interpolation.cpp
+// -----------------
+//
+// Checks that batch interpolation agrees with pointwise interpolation, in
+// particular at points outside of the grid (which are clamped).
+////////////////////////////////////////////////////////////////////////////////
+
+#include <QuantPDE/Core>
+
+using namespace QuantPDE;
+
+#include <algorithm> // std::max, std::min
+#include <array>     // std::array
+#include <cmath>     // std::abs
+#include <iostream>  // std::cerr, std::endl
+
+using namespace std;
+
+// Far enough that the index of a point on a uniform axis overflows
+const Real far = 1e12;
+
+int check(const char *name, const RectilinearGrid2 &grid,
+		const Points2 &points) {
+	// Sum of the coordinates; reproduced exactly by linear interpolation
+	const Vector v = grid.image( [] (Real x, Real y) { return x + y; } );
+	const PiecewiseLinear2 u(grid, v);
+
+	Vector batch;
+	u.interpolate(points, batch);
+
+	int failures = 0;
+	for(Index k = 0; k < points.rows(); ++k) {
+		std::array<Real, 2> x;
+		Real expected = 0.;
+		for(Index d = 0; d < 2; ++d) {
+			x[d] = points(k, d);
+
+			// Clamp to the grid
+			const Axis &axis = grid[d];
+			expected += std::min( std::max(x[d], axis[0]),
+					axis[axis.size() - 1] );
+		}
+
+		const Real pointwise = u.interpolate(x);
+		if(std::abs(batch(k) - pointwise) > 1e-9
+				|| std::abs(batch(k) - expected) > 1e-9) {
+			cerr << name << ": point " << k << ": batch "
+					<< batch(k) << ", pointwise "
+					<< pointwise << ", expected "
+					<< expected << endl;
+			++failures;
+		}
+	}
+
+	return failures;
+}
+
+int main() {
+
+int failures = 0;
+
+Points2 points(10, 2);
+points <<
+	-far,  0.5,
+	-1.,   0.5,
+	 0.,   0.5,
+	 12.3, 0.5,
+	 999., 0.5,
+	 1000.,0.5,
+	 1001.,0.5,
+	 far,  0.5,
+	 far,  far,
+	-far, -far
+;
+
+// Uniform axes
+failures += check("uniform", RectilinearGrid2(
+	Axis::uniform(0., 1000., 129),
+	Axis::uniform(0., 1., 5)
+), points);
+
+// Nonuniform axes
+failures += check("nonuniform", RectilinearGrid2(
+	Axis { 0., 1., 10., 100., 500., 1000. },
+	Axis { 0., 0.25, 1. }
+), points);
+
+return failures == 0 ? 0 : 1;
+
+}